@@ -1,16 +1,153 @@
+#include <lox/batch.h>
 #include <lox/lox.h>
+#include <lox/profiler.h>
+#include <phyto/collections/alloc_stats.h>
+#include <phyto/io/io.h>
+#include <phyto/string/string.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sysexits/sysexits.h>
 
+// one path per line; blank lines are skipped
+static phyto_string_vec_t read_paths(FILE* stream) {
+    phyto_string_vec_t paths = phyto_string_vec_init(&phyto_string_vec_callbacks);
+    while (true) {
+        phyto_string_t line = phyto_io_read_line(stream);
+        if (line.size == 0) {
+            phyto_string_free(&line);
+            break;
+        }
+        while (line.size > 0 &&
+               (line.data[line.size - 1] == '\n' || line.data[line.size - 1] == '\r')) {
+            line.size--;
+        }
+        if (line.size == 0) {
+            phyto_string_free(&line);
+            continue;
+        }
+        phyto_string_append(&line, '\0');
+        phyto_string_vec_append(&paths, line);
+    }
+    return paths;
+}
+
+static int run_batch(lox_context_t* ctx, int argc, char** argv) {
+    if (argc > 0) {
+        return lox_run_batch(ctx, (const char* const*)argv, (size_t)argc, 0);
+    }
+    phyto_string_vec_t lines = read_paths(stdin);
+    const char** paths = calloc(lines.size, sizeof(const char*));
+    if (lines.size > 0 && paths == NULL) {
+        phyto_string_vec_free(&lines);
+        return EX_OSERR;
+    }
+    for (size_t i = 0; i < lines.size; ++i) {
+        paths[i] = lines.data[i].data;
+    }
+    int result = lox_run_batch(ctx, paths, lines.size, 0);
+    free(paths);
+    phyto_string_vec_free(&lines);
+    return result;
+}
+
+// 1ms of CPU time between samples
+#define PROFILE_INTERVAL_US 1000
+
+static int run_profiled(lox_context_t* ctx, const char* script, const char* profile_path) {
+    FILE* profile = fopen(profile_path, "w");
+    if (profile == NULL) {
+        fprintf(stderr, "Could not open profile output: %s\n", profile_path);
+        return EX_CANTCREAT;
+    }
+    if (!lox_profiler_start(ctx, PROFILE_INTERVAL_US)) {
+        fprintf(stderr, "Could not start the profiler\n");
+        fclose(profile);
+        return EX_OSERR;
+    }
+    int result = lox_run_file(ctx, script);
+    lox_profiler_stop(profile, script);
+    fclose(profile);
+    return result;
+}
+
 int main(int argc, char** argv) {
-    if (argc > 2) {
-        printf("Usage: %s [script]\n", argv[0]);
+    lox_context_t ctx = {0};
+    bool batch = false;
+    const char* profile_path = NULL;
+    bool stats = false;
+    bool stats_json = false;
+    bool alloc_stats = false;
+    int arg = 1;
+    for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; ++arg) {
+        if (strcmp(argv[arg], "--fold") == 0) {
+            ctx.fold = true;
+        } else if (strcmp(argv[arg], "--dump-folds") == 0) {
+            ctx.fold = true;
+            ctx.dump_folds = true;
+        } else if (strcmp(argv[arg], "--batch") == 0) {
+            batch = true;
+        } else if (strcmp(argv[arg], "--stats") == 0 || strcmp(argv[arg], "--stats=json") == 0) {
+            stats = true;
+            stats_json = argv[arg][7] == '=';
+        } else if (strcmp(argv[arg], "--alloc-stats") == 0) {
+            alloc_stats = true;
+        } else if (strncmp(argv[arg], "--profile=", 10) == 0) {
+            profile_path = argv[arg] + 10;
+        } else {
+            break;
+        }
+    }
+    bool bad_profile = profile_path != NULL && (batch || argc - arg != 1);
+    if ((!batch && argc - arg > 1) || (arg < argc && strncmp(argv[arg], "--", 2) == 0) ||
+        bad_profile) {
+        printf("Usage: %s [--fold] [--dump-folds] [script]\n", argv[0]);
+        printf("       %s [--fold] [--dump-folds] --profile=<out.folded> script\n", argv[0]);
+        printf("       %s [--fold] [--dump-folds] --batch [script...]\n", argv[0]);
+        printf("--fold prints constant expressions folded; --dump-folds also reports each fold.\n");
+        printf("Any form also takes --stats[=json] in builds configured with LOX_STATS,\n");
+        printf("and --alloc-stats in builds configured with PHYTO_ALLOC_STATS.\n");
         return EX_USAGE;
     }
-    lox_context_t ctx = {0};
-    if (argc == 2) {
-        return lox_run_file(&ctx, argv[1]);
+#ifndef LOX_STATS
+    if (stats) {
+        fprintf(stderr, "--stats needs a build configured with -DLOX_STATS=ON\n");
+        return EX_USAGE;
+    }
+    (void)stats_json;
+#endif
+#ifdef _WIN32
+    if (profile_path != NULL) {
+        fprintf(stderr, "--profile is not supported on Windows\n");
+        return EX_USAGE;
+    }
+#endif
+#ifndef PHYTO_ALLOC_STATS
+    if (alloc_stats) {
+        fprintf(stderr, "--alloc-stats needs a build configured with -DPHYTO_ALLOC_STATS=ON\n");
+        return EX_USAGE;
+    }
+#endif
+    int result = EX_OK;
+    if (profile_path != NULL) {
+        result = run_profiled(&ctx, argv[arg], profile_path);
+    } else if (batch) {
+        result = run_batch(&ctx, argc - arg, argv + arg);
+    } else if (arg < argc) {
+        result = lox_run_file(&ctx, argv[arg]);
+    } else {
+        lox_run_prompt(&ctx);
+    }
+#ifdef LOX_STATS
+    if (stats) {
+        lox_stats_print(&ctx.stats, stderr, stats_json);
+    }
+#endif
+    lox_context_free(&ctx);
+    // after the context is gone, so live bytes show what leaked
+    if (alloc_stats) {
+        phyto_alloc_stats_print(stderr);
     }
-    lox_run_prompt(&ctx);
-    return EX_OK;
+    return result;
 }
@@ -3,12 +3,13 @@
 
 #include <lox/ast.h>
 #include <phyto/string/string.h>
+#include <stdbool.h>
 
 typedef struct {
-    char nothing;
+    phyto_string_t output;
 } lox_ast_printer_t;
 
-LOX_EXPR_VISITOR_DECL(lox, ast_printer, phyto_string_t);
+LOX_EXPR_VISITOR_DECL(lox, ast_printer, bool);
 
 phyto_string_t lox_print_ast(lox_expr_t* expr);
 
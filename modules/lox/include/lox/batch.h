@@ -0,0 +1,19 @@
+#ifndef LOX_BATCH_H_
+#define LOX_BATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lox/lox.h"
+
+// runs every script in its own context on a work-stealing pool of `workers` threads (0 picks
+// one per online processor; Windows builds run the scripts one by one). each script's output
+// and diagnostics are buffered and written to the settings' streams in the order the paths
+// were given, every line prefixed with "<path>: ". returns the status of the first script that
+// failed, or EX_OK. in LOX_STATS builds the workers' statistics are added to settings->stats
+int32_t lox_run_batch(lox_context_t* settings,
+                      const char* const* paths,
+                      size_t count,
+                      size_t workers);
+
+#endif  // LOX_BATCH_H_
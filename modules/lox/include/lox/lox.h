@@ -1,20 +1,51 @@
 #ifndef LOX_LOX_H_
 #define LOX_LOX_H_
 
+#include <phyto/arena/arena.h>
 #include <phyto/string/string.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 
+#include "lox/stats.h"
+
+typedef void (*lox_error_sink_t)(void* user_data,
+                                 uint64_t line,
+                                 phyto_string_span_t where,
+                                 phyto_string_span_t message);
+
+// everything a run touches hangs off the context, so contexts on different threads do not
+// interfere. a zeroed context is ready to use and writes to stdout and stderr
 typedef struct {
     bool had_error;
+    // fold constants and drop groupings before printing; off, the tree is printed as parsed
+    bool fold;
+    bool dump_folds;
+    // NULL means stdout and stderr respectively
+    FILE* out;
+    FILE* err;
+    // when set, diagnostics are handed here instead of being written to `err`
+    lox_error_sink_t error_sink;
+    void* error_sink_data;
+    // syntax trees live here; it is reset after every run and reused by the next
+    phyto_arena_t arena;
+    // what the context is working on right now, kept current for sampling profilers
+    volatile sig_atomic_t phase;
+    volatile sig_atomic_t line;
+#ifdef LOX_STATS
+    lox_stats_t stats;
+#endif
 } lox_context_t;
 
+void lox_context_free(lox_context_t* ctx);
+
 int32_t lox_run_file(lox_context_t* ctx, const char* filename);
 void lox_run_prompt(lox_context_t* ctx);
 void lox_error(lox_context_t* ctx, uint64_t line, phyto_string_span_t message);
 void lox_report(lox_context_t* ctx,
-                       uint64_t line,
-                       phyto_string_span_t where,
-                       phyto_string_span_t message);
+                uint64_t line,
+                phyto_string_span_t where,
+                phyto_string_span_t message);
 
 #endif  // LOX_LOX_H_
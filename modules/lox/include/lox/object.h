@@ -12,6 +12,10 @@
     X(STRING, string)       \
     X(DOUBLE, double)
 
+// integers only stand in for doubles that hold the same value exactly, so anything of a larger
+// magnitude is a double, just as it would be in any other Lox
+#define LOX_OBJECT_INTEGER_MAX (INT64_C(1) << 53)
+
 typedef enum {
 #define X(name, y) LOX_OBJECT_TYPE_##name,
     LOX_OBJECT_TYPES_XY
@@ -36,6 +40,11 @@ lox_object_t lox_object_new_boolean(bool value);
 lox_object_t lox_object_new_string(phyto_string_t value);
 lox_object_t lox_object_new_double(double value);
 void lox_object_free(lox_object_t* obj);
+lox_object_t lox_object_copy(lox_object_t obj);
+bool lox_object_is_truthy(lox_object_t obj);
+bool lox_object_is_number(lox_object_t obj);
+double lox_object_as_double(lox_object_t obj);
+bool lox_object_equals(lox_object_t a, lox_object_t b);
 phyto_string_t lox_object_to_string(lox_object_t obj);
 void lox_object_print(lox_object_t obj);
 
@@ -0,0 +1,22 @@
+#ifndef LOX_OPTIMIZER_H_
+#define LOX_OPTIMIZER_H_
+
+#include <lox/ast.h>
+#include <phyto/arena/arena.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Folds constant subtrees into literals and drops grouping nodes, which carry
+// no meaning once the tree has been parsed. When `dump` is non-NULL, every
+// fold is reported on it.
+typedef struct {
+    phyto_arena_t* arena;
+    FILE* dump;
+    uint64_t folds;
+} lox_optimizer_t;
+
+LOX_EXPR_VISITOR_DECL(lox, optimizer, lox_expr_t*);
+
+lox_expr_t* lox_optimize(lox_expr_t* expr, phyto_arena_t* arena, FILE* dump);
+
+#endif  // LOX_OPTIMIZER_H_
@@ -1,17 +1,20 @@
 #ifndef LOX_PARSER_H_
 #define LOX_PARSER_H_
 
+#include <phyto/arena/arena.h>
+
+#include "lox/ast.h"
 #include "lox/lox.h"
 #include "lox/token.h"
-#include "lox/ast.h"
 
 typedef struct {
     lox_context_t* ctx;
+    phyto_arena_t* arena;
     lox_token_vec_t tokens;
     uint64_t current;
 } lox_parser_t;
 
-lox_parser_t lox_parser_new(lox_context_t* ctx, lox_token_vec_t tokens);
+lox_parser_t lox_parser_new(lox_context_t* ctx, lox_token_vec_t tokens, phyto_arena_t* arena);
 lox_expr_t* lox_parser_parse(lox_parser_t* parser);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef LOX_PROFILER_H_
+#define LOX_PROFILER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "lox/lox.h"
+
+// samples the phase and source line of one context on a SIGPROF timer. a process has only
+// one profiling timer, so only one profiler can run at a time. always fails on Windows,
+// which has no SIGPROF
+bool lox_profiler_start(const lox_context_t* ctx, uint32_t interval_us);
+// stops sampling and, if `folded` is not NULL, writes the samples to it as folded stacks
+// rooted at `root`, one "root;phase;line N count" entry per distinct location
+void lox_profiler_stop(FILE* folded, const char* root);
+
+#endif  // LOX_PROFILER_H_
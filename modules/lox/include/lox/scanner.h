@@ -1,15 +1,13 @@
 #ifndef LOX_SCANNER_H_
 #define LOX_SCANNER_H_
 
-#include <phyto/hash/hash.h>
+#include <phyto/string/string.h>
 #include <stdint.h>
 
 #include "lox/lox.h"
 #include "lox/token.h"
 #include "lox/token_type.h"
 
-PHYTO_HASH_DECL(lox_scanner_keyword_map, lox_token_type_t);
-
 typedef struct {
     lox_context_t* ctx;
     phyto_string_span_t source;
@@ -17,7 +15,6 @@ typedef struct {
     uint64_t start;
     uint64_t current;
     uint64_t line;
-    lox_scanner_keyword_map_t* keywords;
 } lox_scanner_t;
 
 lox_scanner_t lox_scanner_new(lox_context_t* ctx, phyto_string_span_t source);
@@ -0,0 +1,50 @@
+#ifndef LOX_STATS_H_
+#define LOX_STATS_H_
+
+#include <lox/ast.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define LOX_PHASES_X \
+    X(idle)          \
+    X(scan)          \
+    X(parse)         \
+    X(optimize)      \
+    X(print)
+
+typedef enum {
+#define X(x) lox_phase_##x,
+    LOX_PHASES_X
+#undef X
+    lox_phase_count,
+} lox_phase_t;
+
+const char* lox_phase_name(lox_phase_t phase);
+
+// everything below only exists in builds configured with -DLOX_STATS=ON
+#ifdef LOX_STATS
+
+typedef struct {
+    uint64_t runs;
+    // syntax tree nodes by kind, as parsed and as left after folding
+    uint64_t parsed[LOX_EXPR_TYPE_COUNT];
+    uint64_t optimized[LOX_EXPR_TYPE_COUNT];
+    uint64_t phase_ns[lox_phase_count];
+    uint64_t phase_started_ns;
+} lox_stats_t;
+
+typedef struct {
+    uint64_t* counts;
+} lox_node_counter_t;
+
+LOX_EXPR_VISITOR_DECL(lox, node_counter, bool);
+
+uint64_t lox_stats_now_ns(void);
+void lox_stats_count_nodes(lox_expr_t* expr, uint64_t counts[LOX_EXPR_TYPE_COUNT]);
+void lox_stats_merge(lox_stats_t* into, const lox_stats_t* from);
+void lox_stats_print(const lox_stats_t* stats, FILE* stream, bool json);
+
+#endif  // LOX_STATS
+
+#endif  // LOX_STATS_H_
@@ -9,7 +9,8 @@
 
 typedef struct {
     lox_token_type_t type;
-    phyto_string_t lexeme;
+    // borrowed from the scanned source, which outlives every token made from it
+    phyto_string_span_t lexeme;
     lox_object_t literal;
     uint64_t line;
 } lox_token_t;
@@ -20,6 +21,7 @@ lox_token_t lox_token_new(lox_token_type_t type,
                           phyto_string_span_t lexeme,
                           lox_object_t literal,
                           uint64_t line);
+lox_token_t lox_token_copy(lox_token_t token);
 void lox_token_free(lox_token_t* token);
 phyto_string_t lox_token_to_string(lox_token_t token);
 void lox_token_print(lox_token_t token, FILE* stream);
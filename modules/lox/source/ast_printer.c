@@ -4,55 +4,53 @@
 
 #include "lox/object.h"
 
-LOX_EXPR_VISITOR_IMPL(lox, ast_printer, phyto_string_t);
+LOX_EXPR_VISITOR_IMPL(lox, ast_printer, bool);
 
 phyto_string_t lox_print_ast(lox_expr_t* expr) {
-    lox_ast_printer_t printer = {0};
-    return lox_expr_accept_ast_printer(expr, &printer);
+    lox_ast_printer_t printer = {
+        .output = phyto_string_new(),
+    };
+    lox_expr_accept_ast_printer(expr, &printer);
+    return printer.output;
 }
 
-LOX_EXPR_VISITOR_VISIT_BINARY_FUNC(lox, ast_printer, phyto_string_t) {
-    phyto_string_t left = lox_expr_accept_ast_printer(node->left, visitor);
-    phyto_string_t right = lox_expr_accept_ast_printer(node->right, visitor);
-    phyto_string_t result = phyto_string_new();
-    phyto_string_reserve(&result, left.size + right.size + node->op.lexeme.size + 4);
-    phyto_string_append(&result, '(');
-    phyto_string_extend(&result, phyto_string_as_span(node->op.lexeme));
-    phyto_string_append(&result, ' ');
-    phyto_string_extend(&result, phyto_string_as_span(left));
-    phyto_string_free(&left);
-    phyto_string_append(&result, ' ');
-    phyto_string_extend(&result, phyto_string_as_span(right));
-    phyto_string_free(&right);
-    phyto_string_append(&result, ')');
-    return result;
+// every node appends to the same output string, so printing is linear in the
+// size of the tree instead of copying each subtree into its parent
+static bool parenthesize(lox_ast_printer_t* printer,
+                         phyto_string_span_t name,
+                         lox_expr_t* const* exprs,
+                         size_t count) {
+    if (!phyto_string_append(&printer->output, '(') ||
+        !phyto_string_extend(&printer->output, name)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!phyto_string_append(&printer->output, ' ') ||
+            !lox_expr_accept_ast_printer(exprs[i], printer)) {
+            return false;
+        }
+    }
+    return phyto_string_append(&printer->output, ')');
 }
 
-LOX_EXPR_VISITOR_VISIT_GROUPING_FUNC(lox, ast_printer, phyto_string_t) {
-    phyto_string_t expr = lox_expr_accept_ast_printer(node->expression, visitor);
-    phyto_string_t result = phyto_string_new();
-    phyto_string_reserve(&result, expr.size + 8);
-    phyto_string_append_c(&result, "(group ");
-    phyto_string_extend(&result, phyto_string_as_span(expr));
-    phyto_string_free(&expr);
-    phyto_string_append(&result, ')');
-    return result;
+LOX_EXPR_VISITOR_VISIT_BINARY_FUNC(lox, ast_printer, bool) {
+    lox_expr_t* const exprs[] = {node->left, node->right};
+    return parenthesize(visitor, node->op.lexeme, exprs, 2);
 }
 
-LOX_EXPR_VISITOR_VISIT_LITERAL_FUNC(lox, ast_printer, phyto_string_t) {
-    (void)visitor;
-    return lox_object_to_string(node->value);
+LOX_EXPR_VISITOR_VISIT_GROUPING_FUNC(lox, ast_printer, bool) {
+    lox_expr_t* const exprs[] = {node->expression};
+    return parenthesize(visitor, phyto_string_span_from_c("group"), exprs, 1);
 }
 
-LOX_EXPR_VISITOR_VISIT_UNARY_FUNC(lox, ast_printer, phyto_string_t) {
-    phyto_string_t expr = lox_expr_accept_ast_printer(node->right, visitor);
-    phyto_string_t result = phyto_string_new();
-    phyto_string_reserve(&result, expr.size + node->op.lexeme.size + 4);
-    phyto_string_append(&result, '(');
-    phyto_string_extend(&result, phyto_string_as_span(node->op.lexeme));
-    phyto_string_append(&result, ' ');
-    phyto_string_extend(&result, phyto_string_as_span(expr));
-    phyto_string_free(&expr);
-    phyto_string_append(&result, ')');
+LOX_EXPR_VISITOR_VISIT_LITERAL_FUNC(lox, ast_printer, bool) {
+    phyto_string_t value = lox_object_to_string(node->value);
+    bool result = phyto_string_extend(&visitor->output, phyto_string_as_span(value));
+    phyto_string_free(&value);
     return result;
 }
+
+LOX_EXPR_VISITOR_VISIT_UNARY_FUNC(lox, ast_printer, bool) {
+    lox_expr_t* const exprs[] = {node->right};
+    return parenthesize(visitor, node->op.lexeme, exprs, 1);
+}
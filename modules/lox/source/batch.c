@@ -0,0 +1,304 @@
+#include "lox/batch.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits/sysexits.h>
+
+#ifndef _WIN32
+#define PHYTO_COLLECTIONS_CONCURRENT
+#include <phyto/collections/deque.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+typedef struct {
+    char* out;
+    size_t out_size;
+    char* err;
+    size_t err_size;
+    int32_t status;
+    bool done;
+} batch_result_t;
+
+// a stream whose contents end up in a malloc'd buffer once it is closed
+static FILE* capture_open(char** data, size_t* size) {
+#ifdef _WIN32
+    (void)data;
+    (void)size;
+    return tmpfile();
+#else
+    return open_memstream(data, size);
+#endif
+}
+
+static void capture_close(FILE* stream, char** data, size_t* size) {
+#ifdef _WIN32
+    long length = ftell(stream);
+    *data = length > 0 ? malloc((size_t)length) : NULL;
+    *size = 0;
+    if (*data != NULL) {
+        rewind(stream);
+        *size = fread(*data, 1, (size_t)length, stream);
+    }
+#else
+    // closing publishes the buffer into *data and *size
+    (void)data;
+    (void)size;
+#endif
+    fclose(stream);
+}
+
+static batch_result_t run_one(lox_context_t* ctx, const char* path) {
+    batch_result_t result = {0};
+    FILE* out = capture_open(&result.out, &result.out_size);
+    FILE* err = capture_open(&result.err, &result.err_size);
+    if (out == NULL || err == NULL) {
+        result.status = EX_OSERR;
+    } else {
+        ctx->out = out;
+        ctx->err = err;
+        ctx->had_error = false;
+        result.status = lox_run_file(ctx, path);
+    }
+    if (out != NULL) {
+        capture_close(out, &result.out, &result.out_size);
+    }
+    if (err != NULL) {
+        capture_close(err, &result.err, &result.err_size);
+    }
+    return result;
+}
+
+// every line is prefixed with the script it came from, so a batch of thousands stays greppable
+static void write_labelled(FILE* stream, const char* path, const char* data, size_t size) {
+    const char* end = data + size;
+    while (data < end) {
+        const char* newline = memchr(data, '\n', (size_t)(end - data));
+        const char* line_end = newline != NULL ? newline + 1 : end;
+        fprintf(stream, "%s: ", path);
+        fwrite(data, 1, (size_t)(line_end - data), stream);
+        if (newline == NULL) {
+            fputc('\n', stream);
+        }
+        data = line_end;
+    }
+}
+
+static void flush_result(batch_result_t* result, const char* path, FILE* out, FILE* err) {
+    write_labelled(out, path, result->out, result->out_size);
+    write_labelled(err, path, result->err, result->err_size);
+    free(result->out);
+    free(result->err);
+}
+
+#ifdef _WIN32
+
+// no pthreads or memory streams to be had, so the scripts run one after another
+int32_t lox_run_batch(lox_context_t* settings,
+                      const char* const* paths,
+                      size_t count,
+                      size_t workers) {
+    (void)workers;
+    FILE* out = settings->out != NULL ? settings->out : stdout;
+    FILE* err = settings->err != NULL ? settings->err : stderr;
+    lox_context_t ctx = *settings;
+    ctx.arena = phyto_arena_new(settings->arena.block_size);
+#ifdef LOX_STATS
+    ctx.stats = (lox_stats_t){0};
+#endif
+    int32_t status = EX_OK;
+    for (size_t i = 0; i < count; ++i) {
+        batch_result_t result = run_one(&ctx, paths[i]);
+        flush_result(&result, paths[i], out, err);
+        if (status == EX_OK) {
+            status = result.status;
+        }
+    }
+#ifdef LOX_STATS
+    lox_stats_merge(&settings->stats, &ctx.stats);
+#endif
+    lox_context_free(&ctx);
+    return status;
+}
+
+#else
+
+PHYTO_COLLECTIONS_DEQUE_DECL(index_deque, size_t)
+PHYTO_COLLECTIONS_DEQUE_IMPL(index_deque, size_t)
+PHYTO_COLLECTIONS_CONCURRENT_DEQUE_DECL(work_deque, index_deque, size_t)
+PHYTO_COLLECTIONS_CONCURRENT_DEQUE_IMPL(work_deque, index_deque, size_t)
+
+static const index_deque_callbacks_t index_deque_callbacks = {0};
+
+typedef struct batch_s batch_t;
+
+typedef struct {
+    batch_t* batch;
+    size_t id;
+    // indices into the path list; other workers steal from here once their own run dry
+    work_deque_t queue;
+} batch_worker_t;
+
+struct batch_s {
+    lox_context_t* settings;
+    const char* const* paths;
+    size_t count;
+    batch_result_t* results;
+    batch_worker_t* workers;
+    size_t worker_count;
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+};
+
+// nothing is queued once the workers start, so when every queue is empty the batch is done
+static bool next_script(batch_worker_t* worker, size_t* out_index) {
+    batch_t* batch = worker->batch;
+    if (work_deque_pop(&worker->queue, out_index)) {
+        return true;
+    }
+    for (size_t i = 1; i < batch->worker_count; ++i) {
+        batch_worker_t* victim = &batch->workers[(worker->id + i) % batch->worker_count];
+        if (work_deque_steal(&victim->queue, out_index)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void* worker_main(void* arg) {
+    batch_worker_t* worker = arg;
+    batch_t* batch = worker->batch;
+    lox_context_t ctx = *batch->settings;
+    ctx.arena = phyto_arena_new(batch->settings->arena.block_size);
+#ifdef LOX_STATS
+    ctx.stats = (lox_stats_t){0};
+#endif
+    size_t index;
+    while (next_script(worker, &index)) {
+        batch_result_t result = run_one(&ctx, batch->paths[index]);
+
+        pthread_mutex_lock(&batch->lock);
+        result.done = true;
+        batch->results[index] = result;
+        pthread_cond_broadcast(&batch->finished);
+        pthread_mutex_unlock(&batch->lock);
+    }
+#ifdef LOX_STATS
+    pthread_mutex_lock(&batch->lock);
+    lox_stats_merge(&batch->settings->stats, &ctx.stats);
+    pthread_mutex_unlock(&batch->lock);
+#endif
+    lox_context_free(&ctx);
+    return NULL;
+}
+
+static size_t default_workers(void) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return online > 0 ? (size_t)online : 1;
+}
+
+int32_t lox_run_batch(lox_context_t* settings,
+                      const char* const* paths,
+                      size_t count,
+                      size_t workers) {
+    if (count == 0) {
+        return EX_OK;
+    }
+    if (workers == 0) {
+        workers = default_workers();
+    }
+    if (workers > count) {
+        workers = count;
+    }
+    FILE* out = settings->out != NULL ? settings->out : stdout;
+    FILE* err = settings->err != NULL ? settings->err : stderr;
+
+    batch_t batch = {
+        .settings = settings,
+        .paths = paths,
+        .count = count,
+        .results = calloc(count, sizeof(batch_result_t)),
+        .workers = calloc(workers, sizeof(batch_worker_t)),
+        .worker_count = workers,
+    };
+    pthread_t* threads = calloc(workers, sizeof(pthread_t));
+    if (batch.results == NULL || batch.workers == NULL || threads == NULL) {
+        free(batch.results);
+        free(batch.workers);
+        free(threads);
+        return EX_OSERR;
+    }
+    // a queue that cannot be set up takes its worker with it; the rest share the scripts
+    size_t queues = 0;
+    for (; queues < workers; ++queues) {
+        batch_worker_t* worker = &batch.workers[queues];
+        worker->batch = &batch;
+        worker->id = queues;
+        if (!work_deque_init(&worker->queue, count / workers + 1, &index_deque_callbacks)) {
+            break;
+        }
+    }
+    if (queues == 0) {
+        free(threads);
+        free(batch.workers);
+        free(batch.results);
+        return EX_OSERR;
+    }
+    workers = queues;
+    batch.worker_count = workers;
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.finished, NULL);
+
+    // deal scripts out round-robin. each queue is filled back to front so its owner pops
+    // the lowest index first and results arrive roughly in the order they are written out
+    for (size_t i = count; i-- > 0;) {
+        if (!work_deque_push(&batch.workers[i % workers].queue, i)) {
+            // fail it now, or the flush below would wait for it forever
+            batch.results[i] = (batch_result_t){.status = EX_OSERR, .done = true};
+        }
+    }
+
+    size_t started = 0;
+    for (; started < workers; ++started) {
+        if (pthread_create(&threads[started], NULL, worker_main, &batch.workers[started]) != 0) {
+            break;
+        }
+    }
+    if (started == 0) {
+        // no threads to be had; do the work here instead, stealing everything
+        worker_main(&batch.workers[0]);
+    }
+
+    // flush results in submission order while later scripts are still running
+    int32_t status = EX_OK;
+    for (size_t i = 0; i < count; ++i) {
+        pthread_mutex_lock(&batch.lock);
+        while (!batch.results[i].done) {
+            pthread_cond_wait(&batch.finished, &batch.lock);
+        }
+        batch_result_t result = batch.results[i];
+        pthread_mutex_unlock(&batch.lock);
+
+        flush_result(&result, paths[i], out, err);
+        if (status == EX_OK) {
+            status = result.status;
+        }
+    }
+
+    for (size_t i = 0; i < started; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    for (size_t w = 0; w < workers; ++w) {
+        work_deque_free(&batch.workers[w].queue);
+    }
+    pthread_cond_destroy(&batch.finished);
+    pthread_mutex_destroy(&batch.lock);
+    free(threads);
+    free(batch.workers);
+    free(batch.results);
+    return status;
+}
+
+#endif
@@ -10,17 +10,47 @@
 #include "lox/scanner.h"
 #include "lox/token.h"
 #include "lox/ast_printer.h"
+#include "lox/optimizer.h"
 
 static void run(lox_context_t* ctx, phyto_string_span_t source);
 
+static FILE* out_stream(lox_context_t* ctx) {
+    return ctx->out != NULL ? ctx->out : stdout;
+}
+
+static FILE* err_stream(lox_context_t* ctx) {
+    return ctx->err != NULL ? ctx->err : stderr;
+}
+
+static void enter_phase(lox_context_t* ctx, lox_phase_t phase) {
+#ifdef LOX_STATS
+    uint64_t now = lox_stats_now_ns();
+    if (ctx->phase != lox_phase_idle) {
+        ctx->stats.phase_ns[ctx->phase] += now - ctx->stats.phase_started_ns;
+    }
+    ctx->stats.phase_started_ns = now;
+#endif
+    ctx->phase = phase;
+}
+
+#ifdef LOX_STATS
+// the walk is bookkeeping, not work of the phase that built the tree, so it runs untimed
+static void count_nodes(lox_context_t* ctx, lox_expr_t* expression, uint64_t* counts) {
+    enter_phase(ctx, lox_phase_idle);
+    lox_stats_count_nodes(expression, counts);
+}
+#endif
+
 int32_t lox_run_file(lox_context_t* ctx, const char* filename) {
-    phyto_string_t source = phyto_io_read_file(filename);
-    if (source.size == 0) {
-        fprintf(stderr, "Could not read file: %s\n", filename);
+    // scan straight out of the page cache; lexemes borrow from the mapping
+    phyto_io_mapping_t source;
+    if (!phyto_io_map_file(filename, &source)) {
+        phyto_io_unmap_file(&source);
+        fprintf(err_stream(ctx), "Could not read file: %s\n", filename);
         return EX_NOINPUT;
     }
-    run(ctx, phyto_string_as_span(source));
-    phyto_string_free(&source);
+    run(ctx, phyto_io_mapping_as_span(source));
+    phyto_io_unmap_file(&source);
     if (ctx->had_error) {
         return EX_DATAERR;
     }
@@ -29,10 +59,11 @@ int32_t lox_run_file(lox_context_t* ctx, const char* filename) {
 
 void lox_run_prompt(lox_context_t* ctx) {
     while (true) {
-        printf("> ");
+        fprintf(out_stream(ctx), "> ");
+        fflush(out_stream(ctx));
         phyto_string_t source = phyto_io_read_line(stdin);
         if (source.size == 0) {
-            printf("\n");
+            fprintf(out_stream(ctx), "\n");
             break;
         }
         run(ctx, phyto_string_as_span(source));
@@ -41,33 +72,67 @@ void lox_run_prompt(lox_context_t* ctx) {
     }
 }
 
+void lox_context_free(lox_context_t* ctx) {
+    phyto_arena_free(&ctx->arena);
+}
+
 void lox_error(lox_context_t* ctx, uint64_t line, phyto_string_span_t message) {
     lox_report(ctx, line, phyto_string_span_empty(), message);
 }
 
 void run(lox_context_t* ctx, phyto_string_span_t source) {
+    enter_phase(ctx, lox_phase_scan);
+    ctx->line = 1;
     lox_scanner_t scanner = lox_scanner_new(ctx, source);
     lox_token_vec_t tokens = lox_scanner_scan_tokens(&scanner);
-    lox_parser_t parser = lox_parser_new(ctx, tokens);
+    enter_phase(ctx, lox_phase_parse);
+    lox_parser_t parser = lox_parser_new(ctx, tokens, &ctx->arena);
     lox_expr_t* expression = lox_parser_parse(&parser);
     if (ctx->had_error) {
+        if (expression != NULL) {
+            lox_expr_free(expression);
+        }
+        phyto_arena_reset(&ctx->arena);
         lox_scanner_free(&scanner);
+        enter_phase(ctx, lox_phase_idle);
         return;
     }
 
+#ifdef LOX_STATS
+    ctx->stats.runs++;
+    count_nodes(ctx, expression, ctx->stats.parsed);
+#endif
+    if (ctx->fold) {
+        enter_phase(ctx, lox_phase_optimize);
+        ctx->line = 0;
+        expression =
+            lox_optimize(expression, &ctx->arena, ctx->dump_folds ? err_stream(ctx) : NULL);
+#ifdef LOX_STATS
+        count_nodes(ctx, expression, ctx->stats.optimized);
+#endif
+    }
+    enter_phase(ctx, lox_phase_print);
     phyto_string_t str = lox_print_ast(expression);
-    phyto_string_span_print_to(phyto_string_as_span(str), stdout);
-    printf("\n");
+    phyto_string_span_print_to(phyto_string_as_span(str), out_stream(ctx));
+    fputc('\n', out_stream(ctx));
     phyto_string_free(&str);
 
+    lox_expr_free(expression);
+    phyto_arena_reset(&ctx->arena);
     lox_scanner_free(&scanner);
+    enter_phase(ctx, lox_phase_idle);
 }
 
 void lox_report(lox_context_t* ctx,
                 uint64_t line,
                 phyto_string_span_t where,
                 phyto_string_span_t message) {
-    fprintf(stderr, "[line %" PRIu64 "] Error%" PHYTO_STRING_FORMAT ": %" PHYTO_STRING_FORMAT "\n",
-            line, PHYTO_STRING_VIEW_PRINTF_ARGS(where), PHYTO_STRING_VIEW_PRINTF_ARGS(message));
     ctx->had_error = true;
+    if (ctx->error_sink != NULL) {
+        ctx->error_sink(ctx->error_sink_data, line, where, message);
+        return;
+    }
+    fprintf(err_stream(ctx),
+            "[line %" PRIu64 "] Error%" PHYTO_STRING_FORMAT ": %" PHYTO_STRING_FORMAT "\n", line,
+            PHYTO_STRING_VIEW_PRINTF_ARGS(where), PHYTO_STRING_VIEW_PRINTF_ARGS(message));
 }
@@ -1,7 +1,6 @@
 #include "lox/object.h"
 
 #include <assert.h>
-#include <inttypes.h>
 #include <phyto/string/string.h>
 
 static const char* const object_type_names[] = {
@@ -42,7 +41,7 @@ static phyto_string_t stringify_nil_object(lox_object_t obj) {
 }
 
 static phyto_string_t stringify_integer_object(lox_object_t obj) {
-    return phyto_string_from_sprintf("%" PRIu64, obj.integer_value);
+    return phyto_string_from_sprintf("%g", (double)obj.integer_value);
 }
 
 static phyto_string_t stringify_boolean_object(lox_object_t obj) {
@@ -111,6 +110,62 @@ void lox_object_free(lox_object_t* obj) {
     }
 }
 
+lox_object_t lox_object_copy(lox_object_t obj) {
+    if (obj.type == LOX_OBJECT_TYPE_STRING) {
+        return lox_object_new_string(phyto_string_copy(obj.string_value));
+    }
+    return obj;
+}
+
+bool lox_object_is_truthy(lox_object_t obj) {
+    switch (obj.type) {
+        case LOX_OBJECT_TYPE_NIL:
+            return false;
+        case LOX_OBJECT_TYPE_BOOLEAN:
+            return obj.boolean_value;
+        default:
+            return true;
+    }
+}
+
+bool lox_object_is_number(lox_object_t obj) {
+    return obj.type == LOX_OBJECT_TYPE_INTEGER || obj.type == LOX_OBJECT_TYPE_DOUBLE;
+}
+
+double lox_object_as_double(lox_object_t obj) {
+    if (obj.type == LOX_OBJECT_TYPE_INTEGER) {
+        return (double)obj.integer_value;
+    }
+    assert(obj.type == LOX_OBJECT_TYPE_DOUBLE);
+    return obj.double_value;
+}
+
+bool lox_object_equals(lox_object_t a, lox_object_t b) {
+    if (a.type != b.type) {
+        // integers are only a representation of numbers, so 1 == 1.0
+        if (lox_object_is_number(a) && lox_object_is_number(b)) {
+            return lox_object_as_double(a) == lox_object_as_double(b);
+        }
+        return false;
+    }
+    switch (a.type) {
+        case LOX_OBJECT_TYPE_NIL:
+            return true;
+        case LOX_OBJECT_TYPE_INTEGER:
+            return a.integer_value == b.integer_value;
+        case LOX_OBJECT_TYPE_BOOLEAN:
+            return a.boolean_value == b.boolean_value;
+        case LOX_OBJECT_TYPE_STRING:
+            return phyto_string_span_equal(phyto_string_as_span(a.string_value),
+                                           phyto_string_as_span(b.string_value));
+        case LOX_OBJECT_TYPE_DOUBLE:
+            return a.double_value == b.double_value;
+    }
+
+    assert(false && "corrupt object type");
+    return false;
+}
+
 phyto_string_t lox_object_to_string(lox_object_t obj) {
     switch (obj.type) {
 #define X(x, y)               \
@@ -0,0 +1,235 @@
+#include "lox/optimizer.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <phyto/string/string.h>
+
+#include "lox/ast_printer.h"
+#include "lox/object.h"
+#include "lox/token_type.h"
+
+LOX_EXPR_VISITOR_IMPL(lox, optimizer, lox_expr_t*);
+
+lox_expr_t* lox_optimize(lox_expr_t* expr, phyto_arena_t* arena, FILE* dump) {
+    lox_optimizer_t optimizer = {
+        .arena = arena,
+        .dump = dump,
+        .folds = 0,
+    };
+    return lox_expr_accept_optimizer(expr, &optimizer);
+}
+
+static bool is_integer(lox_object_t obj) {
+    return obj.type == LOX_OBJECT_TYPE_INTEGER;
+}
+
+static bool is_string(lox_object_t obj) {
+    return obj.type == LOX_OBJECT_TYPE_STRING;
+}
+
+static bool fold_unary(lox_token_type_t op, lox_object_t right, lox_object_t* out) {
+    switch (op) {
+        case lox_token_type_minus:
+            // integers have no negative zero, so -0 takes the double path below
+            if (is_integer(right) && right.integer_value != INT64_MIN && right.integer_value != 0) {
+                *out = lox_object_new_integer(-right.integer_value);
+                return true;
+            }
+            if (!lox_object_is_number(right)) {
+                return false;
+            }
+            *out = lox_object_new_double(-lox_object_as_double(right));
+            return true;
+        case lox_token_type_bang:
+            *out = lox_object_new_boolean(!lox_object_is_truthy(right));
+            return true;
+        default:
+            return false;
+    }
+}
+
+// fails when the result is not an integer a double holds exactly, in which case the caller redoes
+// the operation in double precision. that includes a zero that doubles would give a negative sign
+static bool fold_integer(lox_token_type_t op, int64_t a, int64_t b, lox_object_t* out) {
+    int64_t result;
+    switch (op) {
+        case lox_token_type_plus:
+            if (__builtin_add_overflow(a, b, &result)) {
+                return false;
+            }
+            break;
+        case lox_token_type_minus:
+            if (__builtin_sub_overflow(a, b, &result)) {
+                return false;
+            }
+            break;
+        case lox_token_type_star:
+            if (__builtin_mul_overflow(a, b, &result) || (result == 0 && (a < 0) != (b < 0))) {
+                return false;
+            }
+            break;
+        case lox_token_type_slash:
+            if (b == 0 || (a == INT64_MIN && b == -1) || a % b != 0) {
+                return false;
+            }
+            result = a / b;
+            if (result == 0 && (a < 0) != (b < 0)) {
+                return false;
+            }
+            break;
+        case lox_token_type_greater:
+            *out = lox_object_new_boolean(a > b);
+            return true;
+        case lox_token_type_greater_equal:
+            *out = lox_object_new_boolean(a >= b);
+            return true;
+        case lox_token_type_less:
+            *out = lox_object_new_boolean(a < b);
+            return true;
+        case lox_token_type_less_equal:
+            *out = lox_object_new_boolean(a <= b);
+            return true;
+        default:
+            return false;
+    }
+    if (result > LOX_OBJECT_INTEGER_MAX || result < -LOX_OBJECT_INTEGER_MAX) {
+        return false;
+    }
+    *out = lox_object_new_integer(result);
+    return true;
+}
+
+static bool fold_binary(lox_token_type_t op,
+                        lox_object_t* left,
+                        lox_object_t right,
+                        lox_object_t* out) {
+    switch (op) {
+        case lox_token_type_bang_equal:
+            *out = lox_object_new_boolean(!lox_object_equals(*left, right));
+            return true;
+        case lox_token_type_equal_equal:
+            *out = lox_object_new_boolean(lox_object_equals(*left, right));
+            return true;
+        case lox_token_type_plus:
+            if (is_string(*left) && is_string(right)) {
+                // take over the left operand's buffer and append in place, so a chain of
+                // concatenations folds in amortized linear time instead of copying the
+                // accumulated string at every step
+                phyto_string_t result = left->string_value;
+                *left = lox_object_new_nil();
+                phyto_string_extend(&result, phyto_string_as_span(right.string_value));
+                *out = lox_object_new_string(result);
+                return true;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // everything else needs numbers; other operands are a runtime error, so leave them be
+    if (!lox_object_is_number(*left) || !lox_object_is_number(right)) {
+        return false;
+    }
+    if (is_integer(*left) && is_integer(right) &&
+        fold_integer(op, left->integer_value, right.integer_value, out)) {
+        return true;
+    }
+    double a = lox_object_as_double(*left);
+    double b = lox_object_as_double(right);
+    switch (op) {
+        case lox_token_type_plus:
+            *out = lox_object_new_double(a + b);
+            return true;
+        case lox_token_type_minus:
+            *out = lox_object_new_double(a - b);
+            return true;
+        case lox_token_type_star:
+            *out = lox_object_new_double(a * b);
+            return true;
+        case lox_token_type_slash:
+            *out = lox_object_new_double(a / b);
+            return true;
+        case lox_token_type_greater:
+            *out = lox_object_new_boolean(a > b);
+            return true;
+        case lox_token_type_greater_equal:
+            *out = lox_object_new_boolean(a >= b);
+            return true;
+        case lox_token_type_less:
+            *out = lox_object_new_boolean(a < b);
+            return true;
+        case lox_token_type_less_equal:
+            *out = lox_object_new_boolean(a <= b);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static phyto_string_t render_for_dump(lox_optimizer_t* optimizer, lox_expr_t* node) {
+    if (optimizer->dump == NULL) {
+        return phyto_string_new();
+    }
+    return lox_print_ast(node);
+}
+
+static lox_expr_t* replace_with_literal(lox_optimizer_t* optimizer,
+                                        lox_expr_t* node,
+                                        phyto_string_t before,
+                                        uint64_t line,
+                                        lox_object_t value) {
+    if (optimizer->dump != NULL) {
+        phyto_string_t after = lox_object_to_string(value);
+        fprintf(optimizer->dump,
+                "[line %" PRIu64 "] fold %" PHYTO_STRING_FORMAT " => %" PHYTO_STRING_FORMAT "\n",
+                line, PHYTO_STRING_PRINTF_ARGS(before), PHYTO_STRING_PRINTF_ARGS(after));
+        phyto_string_free(&after);
+    }
+    phyto_string_free(&before);
+    optimizer->folds++;
+    lox_expr_free(node);
+    return (lox_expr_t*)lox_expr_new_literal(optimizer->arena, value);
+}
+
+LOX_EXPR_VISITOR_VISIT_BINARY_FUNC(lox, optimizer, lox_expr_t*) {
+    node->left = lox_expr_accept_optimizer(node->left, visitor);
+    node->right = lox_expr_accept_optimizer(node->right, visitor);
+    if (node->left->type != lox_expr_type_literal || node->right->type != lox_expr_type_literal) {
+        return (lox_expr_t*)node;
+    }
+
+    phyto_string_t before = render_for_dump(visitor, (lox_expr_t*)node);
+    lox_object_t value;
+    if (!fold_binary(node->op.type, &((lox_literal_expr_t*)node->left)->value,
+                     ((lox_literal_expr_t*)node->right)->value, &value)) {
+        phyto_string_free(&before);
+        return (lox_expr_t*)node;
+    }
+    return replace_with_literal(visitor, (lox_expr_t*)node, before, node->op.line, value);
+}
+
+LOX_EXPR_VISITOR_VISIT_GROUPING_FUNC(lox, optimizer, lox_expr_t*) {
+    lox_expr_t* expression = lox_expr_accept_optimizer(node->expression, visitor);
+    node->expression = NULL;
+    lox_expr_free((lox_expr_t*)node);
+    return expression;
+}
+
+LOX_EXPR_VISITOR_VISIT_LITERAL_FUNC(lox, optimizer, lox_expr_t*) {
+    (void)visitor;
+    return (lox_expr_t*)node;
+}
+
+LOX_EXPR_VISITOR_VISIT_UNARY_FUNC(lox, optimizer, lox_expr_t*) {
+    node->right = lox_expr_accept_optimizer(node->right, visitor);
+    if (node->right->type != lox_expr_type_literal) {
+        return (lox_expr_t*)node;
+    }
+
+    lox_object_t value;
+    if (!fold_unary(node->op.type, ((lox_literal_expr_t*)node->right)->value, &value)) {
+        return (lox_expr_t*)node;
+    }
+    phyto_string_t before = render_for_dump(visitor, (lox_expr_t*)node);
+    return replace_with_literal(visitor, (lox_expr_t*)node, before, node->op.line, value);
+}
@@ -36,9 +36,10 @@ static void synchronize(lox_parser_t* parser);
 
 #define MATCH(parser, ...) match(parser, __VA_ARGS__, lox_token_type_eof)
 
-lox_parser_t lox_parser_new(lox_context_t* ctx, lox_token_vec_t tokens) {
+lox_parser_t lox_parser_new(lox_context_t* ctx, lox_token_vec_t tokens, phyto_arena_t* arena) {
     return (lox_parser_t){
         .ctx = ctx,
+        .arena = arena,
         .tokens = tokens,
         .current = 0,
     };
@@ -84,7 +85,8 @@ parse_result_t equality(lox_parser_t* parser) {
             lox_expr_free(left);
             return right_result;
         }
-        left = (lox_expr_t*)lox_expr_new_binary(left, oper, right_result.expression);
+        left = (lox_expr_t*)lox_expr_new_binary(parser->arena, left, lox_token_copy(oper),
+                                                right_result.expression);
     }
 
     return parse_success(left);
@@ -105,7 +107,8 @@ parse_result_t comparison(lox_parser_t* parser) {
             lox_expr_free(left);
             return right_result;
         }
-        left = (lox_expr_t*)lox_expr_new_binary(left, oper, right_result.expression);
+        left = (lox_expr_t*)lox_expr_new_binary(parser->arena, left, lox_token_copy(oper),
+                                                right_result.expression);
     }
 
     return parse_success(left);
@@ -125,7 +128,8 @@ parse_result_t term(lox_parser_t* parser) {
             lox_expr_free(left);
             return right_result;
         }
-        left = (lox_expr_t*)lox_expr_new_binary(left, oper, right_result.expression);
+        left = (lox_expr_t*)lox_expr_new_binary(parser->arena, left, lox_token_copy(oper),
+                                                right_result.expression);
     }
 
     return parse_success(left);
@@ -145,7 +149,8 @@ parse_result_t factor(lox_parser_t* parser) {
             lox_expr_free(left);
             return right_result;
         }
-        left = (lox_expr_t*)lox_expr_new_binary(left, oper, right_result.expression);
+        left = (lox_expr_t*)lox_expr_new_binary(parser->arena, left, lox_token_copy(oper),
+                                                right_result.expression);
     }
 
     return parse_success(left);
@@ -158,7 +163,9 @@ parse_result_t unary(lox_parser_t* parser) {
         if (!right_result.success) {
             return right_result;
         }
-        return parse_success((lox_expr_t*)lox_expr_new_unary(oper, right_result.expression));
+        return parse_success(
+            (lox_expr_t*)lox_expr_new_unary(parser->arena, lox_token_copy(oper),
+                                            right_result.expression));
     }
 
     return primary(parser);
@@ -166,16 +173,20 @@ parse_result_t unary(lox_parser_t* parser) {
 
 parse_result_t primary(lox_parser_t* parser) {
     if (MATCH(parser, lox_token_type_kw_false)) {
-        return parse_success((lox_expr_t*)lox_expr_new_literal(lox_object_new_boolean(false)));
+        return parse_success(
+            (lox_expr_t*)lox_expr_new_literal(parser->arena, lox_object_new_boolean(false)));
     }
     if (MATCH(parser, lox_token_type_kw_true)) {
-        return parse_success((lox_expr_t*)lox_expr_new_literal(lox_object_new_boolean(true)));
+        return parse_success(
+            (lox_expr_t*)lox_expr_new_literal(parser->arena, lox_object_new_boolean(true)));
     }
     if (MATCH(parser, lox_token_type_kw_nil)) {
-        return parse_success((lox_expr_t*)lox_expr_new_literal(lox_object_new_nil()));
+        return parse_success(
+            (lox_expr_t*)lox_expr_new_literal(parser->arena, lox_object_new_nil()));
     }
     if (MATCH(parser, lox_token_type_number, lox_token_type_string)) {
-        return parse_success((lox_expr_t*)lox_expr_new_literal(previous(parser).literal));
+        return parse_success((lox_expr_t*)lox_expr_new_literal(
+            parser->arena, lox_object_copy(previous(parser).literal)));
     }
     if (MATCH(parser, lox_token_type_left_paren)) {
         parse_result_t expr_result = expression(parser);
@@ -187,7 +198,8 @@ parse_result_t primary(lox_parser_t* parser) {
         if (!consume_result.success) {
             return consume_result;
         }
-        return parse_success((lox_expr_t*)lox_expr_new_grouping(expr_result.expression));
+        return parse_success(
+            (lox_expr_t*)lox_expr_new_grouping(parser->arena, expr_result.expression));
     }
 
     return error(parser, *peek(parser), "Expect expression.");
@@ -218,7 +230,9 @@ lox_token_t advance(lox_parser_t* parser) {
     if (!is_at_end(parser)) {
         parser->current++;
     }
-    return previous(parser);
+    lox_token_t token = previous(parser);
+    parser->ctx->line = (sig_atomic_t)token.line;
+    return token;
 }
 
 lox_token_t* peek(lox_parser_t* parser) {
@@ -245,8 +259,8 @@ parse_result_t error(lox_parser_t* parser, lox_token_t token, const char* messag
         lox_report(parser->ctx, token.line, phyto_string_span_from_c(" at end"),
                    phyto_string_span_from_c(message));
     } else {
-        phyto_string_t where =
-            phyto_string_from_sprintf("at '%" PHYTO_STRING_FORMAT "'", token.lexeme);
+        phyto_string_t where = phyto_string_from_sprintf(
+            " at '%" PHYTO_STRING_FORMAT "'", PHYTO_STRING_VIEW_PRINTF_ARGS(token.lexeme));
         lox_report(parser->ctx, token.line, phyto_string_as_span(where),
                    phyto_string_span_from_c(message));
         phyto_string_free(&where);
@@ -0,0 +1,127 @@
+#include "lox/profiler.h"
+
+#ifdef _WIN32
+
+// there is no SIGPROF or setitimer to sample with
+bool lox_profiler_start(const lox_context_t* ctx, uint32_t interval_us) {
+    (void)ctx;
+    (void)interval_us;
+    return false;
+}
+
+void lox_profiler_stop(FILE* folded, const char* root) {
+    (void)folded;
+    (void)root;
+}
+
+#else
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+typedef struct {
+    sig_atomic_t phase;
+    sig_atomic_t line;
+} sample_t;
+
+// enough for over a minute at the default interval; later samples are counted and dropped
+#define SAMPLE_CAPACITY ((size_t)1 << 16)
+
+// the signal handler has no other way to reach its state
+static const lox_context_t* profiled;
+static sample_t* samples;
+static size_t sample_count;
+static struct sigaction previous_action;
+
+static void on_sigprof(int signo) {
+    (void)signo;
+    const lox_context_t* ctx = profiled;
+    if (ctx == NULL) {
+        return;
+    }
+    size_t index = __atomic_fetch_add(&sample_count, 1, __ATOMIC_RELAXED);
+    if (index < SAMPLE_CAPACITY) {
+        samples[index] = (sample_t){.phase = ctx->phase, .line = ctx->line};
+    }
+}
+
+static int compare_samples(const void* a, const void* b) {
+    const sample_t* lhs = a;
+    const sample_t* rhs = b;
+    if (lhs->phase != rhs->phase) {
+        return (lhs->phase > rhs->phase) - (lhs->phase < rhs->phase);
+    }
+    return (lhs->line > rhs->line) - (lhs->line < rhs->line);
+}
+
+static void write_folded(FILE* stream, const char* root, size_t count) {
+    qsort(samples, count, sizeof(sample_t), compare_samples);
+    for (size_t i = 0; i < count;) {
+        size_t run = 1;
+        while (i + run < count && compare_samples(&samples[i], &samples[i + run]) == 0) {
+            ++run;
+        }
+        fprintf(stream, "%s;%s", root, lox_phase_name((lox_phase_t)samples[i].phase));
+        if (samples[i].line > 0) {
+            fprintf(stream, ";line %d", (int)samples[i].line);
+        }
+        fprintf(stream, " %zu\n", run);
+        i += run;
+    }
+}
+
+static void release_samples(void) {
+    profiled = NULL;
+    free(samples);
+    samples = NULL;
+}
+
+bool lox_profiler_start(const lox_context_t* ctx, uint32_t interval_us) {
+    if (profiled != NULL || interval_us == 0) {
+        return false;
+    }
+    samples = calloc(SAMPLE_CAPACITY, sizeof(sample_t));
+    if (samples == NULL) {
+        return false;
+    }
+    sample_count = 0;
+    profiled = ctx;
+
+    struct sigaction action = {0};
+    action.sa_handler = on_sigprof;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    struct itimerval timer = {
+        .it_interval = {.tv_sec = interval_us / 1000000, .tv_usec = interval_us % 1000000},
+    };
+    timer.it_value = timer.it_interval;
+    if (sigaction(SIGPROF, &action, &previous_action) != 0) {
+        release_samples();
+        return false;
+    }
+    if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+        sigaction(SIGPROF, &previous_action, NULL);
+        release_samples();
+        return false;
+    }
+    return true;
+}
+
+void lox_profiler_stop(FILE* folded, const char* root) {
+    if (profiled == NULL) {
+        return;
+    }
+    struct itimerval off = {0};
+    setitimer(ITIMER_PROF, &off, NULL);
+    sigaction(SIGPROF, &previous_action, NULL);
+
+    size_t count = sample_count < SAMPLE_CAPACITY ? sample_count : SAMPLE_CAPACITY;
+    if (folded != NULL) {
+        write_folded(folded, root, count);
+    }
+    release_samples();
+}
+
+#endif
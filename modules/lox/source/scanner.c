@@ -2,7 +2,9 @@
 
 #include <nonstd/ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "lox/lox.h"
 #include "lox/object.h"
@@ -10,22 +12,11 @@
 #include "lox/token_type.h"
 #include "phyto/string/string.h"
 
-PHYTO_HASH_IMPL(lox_scanner_keyword_map, lox_token_type_t);
-
 static const lox_token_vec_callbacks_t lox_token_vec_callbacks = {
     .free_cb = lox_token_free,
     .print_cb = lox_token_print,
 };
 
-static const lox_scanner_keyword_map_key_ops_t key_ops = {
-    .hash = phyto_hash_djb2,
-};
-
-static const lox_scanner_keyword_map_value_ops_t value_ops = {
-    .compare = lox_token_type_cmp,
-    .print = lox_token_type_print_to,
-};
-
 static bool is_at_end(lox_scanner_t* scanner) {
     return scanner->current >= scanner->source.size;
 }
@@ -77,6 +68,7 @@ static void string(lox_scanner_t* scanner) {
     while (peek(scanner) != '"' && !is_at_end(scanner)) {
         if (peek(scanner) == '\n') {
             scanner->line++;
+            scanner->ctx->line = (sig_atomic_t)scanner->line;
         }
         advance(scanner);
     }
@@ -97,7 +89,9 @@ static void number(lox_scanner_t* scanner) {
         advance(scanner);
     }
 
+    bool is_integer = true;
     if (peek(scanner) == '.' && nonstd_isdigit(peek_next(scanner))) {
+        is_integer = false;
         advance(scanner);
 
         while (nonstd_isdigit(peek(scanner))) {
@@ -105,8 +99,105 @@ static void number(lox_scanner_t* scanner) {
         }
     }
 
-    add_token_literal(scanner, lox_token_type_number,
-                      lox_object_new_double(strtod(scanner->source.begin + scanner->start, NULL)));
+    phyto_string_span_t text =
+        phyto_string_span_subspan(scanner->source, scanner->start, scanner->current);
+    if (is_integer) {
+        int64_t value = 0;
+        bool overflow = false;
+        for (size_t i = 0; i < text.size && !overflow; ++i) {
+            overflow = __builtin_mul_overflow(value, 10, &value) ||
+                       __builtin_add_overflow(value, text.begin[i] - '0', &value);
+        }
+        if (!overflow && value <= LOX_OBJECT_INTEGER_MAX) {
+            add_token_literal(scanner, lox_token_type_number, lox_object_new_integer(value));
+            return;
+        }
+    }
+    // strtod needs a terminator, and a mapped source has none past its last byte. only
+    // absurdly long literals are worth a heap copy
+    double value;
+    char digits[64];
+    if (text.size < sizeof(digits)) {
+        memcpy(digits, text.begin, text.size);
+        digits[text.size] = '\0';
+        value = strtod(digits, NULL);
+    } else {
+        phyto_string_t long_digits = phyto_string_own(text);
+        phyto_string_append(&long_digits, '\0');
+        value = strtod(long_digits.data, NULL);
+        phyto_string_free(&long_digits);
+    }
+    add_token_literal(scanner, lox_token_type_number, lox_object_new_double(value));
+}
+
+static lox_token_type_t check_keyword(lox_scanner_t* scanner,
+                                      uint64_t start,
+                                      const char* rest,
+                                      lox_token_type_t type) {
+    uint64_t length = strlen(rest);
+    if (scanner->current - scanner->start == start + length &&
+        memcmp(scanner->source.begin + scanner->start + start, rest, length) == 0) {
+        return type;
+    }
+    return lox_token_type_identifier;
+}
+
+static lox_token_type_t identifier_type(lox_scanner_t* scanner) {
+    const char* lexeme = scanner->source.begin + scanner->start;
+    uint64_t length = scanner->current - scanner->start;
+    switch (lexeme[0]) {
+        case 'a':
+            return check_keyword(scanner, 1, "nd", lox_token_type_kw_and);
+        case 'c':
+            return check_keyword(scanner, 1, "lass", lox_token_type_kw_class);
+        case 'e':
+            return check_keyword(scanner, 1, "lse", lox_token_type_kw_else);
+        case 'f':
+            if (length > 1) {
+                switch (lexeme[1]) {
+                    case 'a':
+                        return check_keyword(scanner, 2, "lse", lox_token_type_kw_false);
+                    case 'o':
+                        return check_keyword(scanner, 2, "r", lox_token_type_kw_for);
+                    case 'u':
+                        return check_keyword(scanner, 2, "n", lox_token_type_kw_fun);
+                    default:
+                        break;
+                }
+            }
+            break;
+        case 'i':
+            return check_keyword(scanner, 1, "f", lox_token_type_kw_if);
+        case 'n':
+            return check_keyword(scanner, 1, "il", lox_token_type_kw_nil);
+        case 'o':
+            return check_keyword(scanner, 1, "r", lox_token_type_kw_or);
+        case 'p':
+            return check_keyword(scanner, 1, "rint", lox_token_type_kw_print);
+        case 'r':
+            return check_keyword(scanner, 1, "eturn", lox_token_type_kw_return);
+        case 's':
+            return check_keyword(scanner, 1, "uper", lox_token_type_kw_super);
+        case 't':
+            if (length > 1) {
+                switch (lexeme[1]) {
+                    case 'h':
+                        return check_keyword(scanner, 2, "is", lox_token_type_kw_this);
+                    case 'r':
+                        return check_keyword(scanner, 2, "ue", lox_token_type_kw_true);
+                    default:
+                        break;
+                }
+            }
+            break;
+        case 'v':
+            return check_keyword(scanner, 1, "ar", lox_token_type_kw_var);
+        case 'w':
+            return check_keyword(scanner, 1, "hile", lox_token_type_kw_while);
+        default:
+            break;
+    }
+    return lox_token_type_identifier;
 }
 
 static void identifier(lox_scanner_t* scanner) {
@@ -114,14 +205,7 @@ static void identifier(lox_scanner_t* scanner) {
         advance(scanner);
     }
 
-    phyto_string_span_t value =
-        phyto_string_span_subspan(scanner->source, scanner->start, scanner->current);
-    lox_token_type_t* type = lox_scanner_keyword_map_get_ref(scanner->keywords, value);
-    if (type != NULL) {
-        add_token(scanner, *type);
-    } else {
-        add_token(scanner, lox_token_type_identifier);
-    }
+    add_token(scanner, identifier_type(scanner));
 }
 
 static void scan_token(lox_scanner_t* scanner) {
@@ -188,6 +272,7 @@ static void scan_token(lox_scanner_t* scanner) {
             break;
         case '\n':
             scanner->line++;
+            scanner->ctx->line = (sig_atomic_t)scanner->line;
             break;
         case '"':
             string(scanner);
@@ -213,40 +298,7 @@ lox_scanner_t lox_scanner_new(lox_context_t* ctx, phyto_string_span_t source) {
         .start = 0,
         .current = 0,
         .line = 1,
-        .keywords = lox_scanner_keyword_map_new(20, phyto_hash_default_load, &key_ops, &value_ops),
     };
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("and"),
-                                   lox_token_type_kw_and);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("class"),
-                                   lox_token_type_kw_class);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("else"),
-                                   lox_token_type_kw_else);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("false"),
-                                   lox_token_type_kw_false);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("for"),
-                                   lox_token_type_kw_for);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("fun"),
-                                   lox_token_type_kw_fun);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("if"),
-                                   lox_token_type_kw_if);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("nil"),
-                                   lox_token_type_kw_nil);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("or"),
-                                   lox_token_type_kw_or);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("print"),
-                                   lox_token_type_kw_print);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("return"),
-                                   lox_token_type_kw_return);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("super"),
-                                   lox_token_type_kw_super);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("this"),
-                                   lox_token_type_kw_this);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("true"),
-                                   lox_token_type_kw_true);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("var"),
-                                   lox_token_type_kw_var);
-    lox_scanner_keyword_map_insert(scanner.keywords, phyto_string_span_from_c("while"),
-                                   lox_token_type_kw_while);
     scanner.tokens = lox_token_vec_init(&lox_token_vec_callbacks);
     return scanner;
 }
@@ -265,6 +317,4 @@ lox_token_vec_t lox_scanner_scan_tokens(lox_scanner_t* scanner) {
 
 void lox_scanner_free(lox_scanner_t* scanner) {
     lox_token_vec_free(&scanner->tokens);
-    lox_scanner_keyword_map_free(scanner->keywords);
-    scanner->keywords = NULL;
 }
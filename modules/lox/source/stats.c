@@ -0,0 +1,132 @@
+#include "lox/stats.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <time.h>
+
+const char* lox_phase_name(lox_phase_t phase) {
+    static const char* const names[] = {
+#define X(x) #x,
+        LOX_PHASES_X
+#undef X
+    };
+    return names[phase];
+}
+
+#ifdef LOX_STATS
+
+LOX_EXPR_VISITOR_IMPL(lox, node_counter, bool);
+
+uint64_t lox_stats_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+void lox_stats_count_nodes(lox_expr_t* expr, uint64_t counts[LOX_EXPR_TYPE_COUNT]) {
+    lox_node_counter_t counter = {.counts = counts};
+    lox_expr_accept_node_counter(expr, &counter);
+}
+
+LOX_EXPR_VISITOR_VISIT_BINARY_FUNC(lox, node_counter, bool) {
+    visitor->counts[lox_expr_type_binary]++;
+    return lox_expr_accept_node_counter(node->left, visitor) &&
+           lox_expr_accept_node_counter(node->right, visitor);
+}
+
+LOX_EXPR_VISITOR_VISIT_GROUPING_FUNC(lox, node_counter, bool) {
+    visitor->counts[lox_expr_type_grouping]++;
+    return lox_expr_accept_node_counter(node->expression, visitor);
+}
+
+LOX_EXPR_VISITOR_VISIT_LITERAL_FUNC(lox, node_counter, bool) {
+    (void)node;
+    visitor->counts[lox_expr_type_literal]++;
+    return true;
+}
+
+LOX_EXPR_VISITOR_VISIT_UNARY_FUNC(lox, node_counter, bool) {
+    visitor->counts[lox_expr_type_unary]++;
+    return lox_expr_accept_node_counter(node->right, visitor);
+}
+
+void lox_stats_merge(lox_stats_t* into, const lox_stats_t* from) {
+    into->runs += from->runs;
+    for (size_t i = 0; i < LOX_EXPR_TYPE_COUNT; ++i) {
+        into->parsed[i] += from->parsed[i];
+        into->optimized[i] += from->optimized[i];
+    }
+    for (size_t i = 0; i < lox_phase_count; ++i) {
+        into->phase_ns[i] += from->phase_ns[i];
+    }
+}
+
+typedef struct {
+    size_t index;
+    uint64_t value;
+} row_t;
+
+static int compare_rows(const void* a, const void* b) {
+    const row_t* lhs = a;
+    const row_t* rhs = b;
+    // largest first
+    return (lhs->value < rhs->value) - (lhs->value > rhs->value);
+}
+
+static void print_json(const lox_stats_t* stats, FILE* stream) {
+    fprintf(stream, "{\"runs\": %" PRIu64 ", \"nodes\": {", stats->runs);
+    for (size_t i = 0; i < LOX_EXPR_TYPE_COUNT; ++i) {
+        fprintf(stream, "%s\"%s\": {\"parsed\": %" PRIu64 ", \"optimized\": %" PRIu64 "}",
+                i == 0 ? "" : ", ", lox_expr_type_name((lox_expr_type_t)i), stats->parsed[i],
+                stats->optimized[i]);
+    }
+    fprintf(stream, "}, \"phase_ns\": {");
+    for (size_t i = lox_phase_idle + 1; i < lox_phase_count; ++i) {
+        fprintf(stream, "%s\"%s\": %" PRIu64, i == lox_phase_idle + 1 ? "" : ", ",
+                lox_phase_name((lox_phase_t)i), stats->phase_ns[i]);
+    }
+    fprintf(stream, "}}\n");
+}
+
+static void print_table(const lox_stats_t* stats, FILE* stream) {
+    row_t nodes[LOX_EXPR_TYPE_COUNT];
+    for (size_t i = 0; i < LOX_EXPR_TYPE_COUNT; ++i) {
+        nodes[i] = (row_t){.index = i, .value = stats->parsed[i]};
+    }
+    qsort(nodes, LOX_EXPR_TYPE_COUNT, sizeof(row_t), compare_rows);
+    fprintf(stream, "%" PRIu64 " runs\n\n", stats->runs);
+    fprintf(stream, "%-10s %14s %14s\n", "node", "parsed", "optimized");
+    for (size_t i = 0; i < LOX_EXPR_TYPE_COUNT; ++i) {
+        size_t kind = nodes[i].index;
+        fprintf(stream, "%-10s %14" PRIu64 " %14" PRIu64 "\n",
+                lox_expr_type_name((lox_expr_type_t)kind), stats->parsed[kind],
+                stats->optimized[kind]);
+    }
+
+    row_t phases[lox_phase_count];
+    uint64_t total_ns = 0;
+    for (size_t i = 0; i < lox_phase_count; ++i) {
+        phases[i] = (row_t){.index = i, .value = stats->phase_ns[i]};
+        total_ns += stats->phase_ns[i];
+    }
+    qsort(phases, lox_phase_count, sizeof(row_t), compare_rows);
+    fprintf(stream, "\n%-10s %14s %8s\n", "phase", "ms", "share");
+    for (size_t i = 0; i < lox_phase_count; ++i) {
+        if (phases[i].index == lox_phase_idle) {
+            continue;
+        }
+        double share = total_ns == 0 ? 0.0 : 100.0 * (double)phases[i].value / (double)total_ns;
+        fprintf(stream, "%-10s %14.3f %7.1f%%\n", lox_phase_name((lox_phase_t)phases[i].index),
+                (double)phases[i].value / 1e6, share);
+    }
+}
+
+void lox_stats_print(const lox_stats_t* stats, FILE* stream, bool json) {
+    if (json) {
+        print_json(stats, stream);
+    } else {
+        print_table(stats, stream);
+    }
+}
+
+#endif  // LOX_STATS
@@ -11,23 +11,26 @@ lox_token_t lox_token_new(lox_token_type_t type,
                           uint64_t line) {
     lox_token_t token = {
         .type = type,
-        .lexeme = phyto_string_own(lexeme),
+        .lexeme = lexeme,
         .literal = literal,
         .line = line,
     };
     return token;
 }
 
+lox_token_t lox_token_copy(lox_token_t token) {
+    return lox_token_new(token.type, token.lexeme, lox_object_copy(token.literal), token.line);
+}
+
 void lox_token_free(lox_token_t* token) {
     lox_object_free(&token->literal);
-    phyto_string_free(&token->lexeme);
 }
 
 phyto_string_t lox_token_to_string(lox_token_t token) {
     phyto_string_t str = phyto_string_new();
     phyto_string_extend(&str, lox_token_type_name(token.type));
     phyto_string_append(&str, ' ');
-    phyto_string_extend(&str, phyto_string_as_span(token.lexeme));
+    phyto_string_extend(&str, token.lexeme);
     phyto_string_append(&str, ' ');
     phyto_string_t literal = lox_object_to_string(token.literal);
     phyto_string_extend(&str, phyto_string_as_span(literal));
@@ -39,6 +42,6 @@ void lox_token_print(lox_token_t token, FILE* stream) {
     phyto_string_t literal = lox_object_to_string(token.literal);
     fprintf(stream, "%" PHYTO_STRING_FORMAT " %" PHYTO_STRING_FORMAT " %" PHYTO_STRING_FORMAT,
             PHYTO_STRING_VIEW_PRINTF_ARGS(lox_token_type_name(token.type)),
-            PHYTO_STRING_PRINTF_ARGS(token.lexeme), PHYTO_STRING_PRINTF_ARGS(literal));
+            PHYTO_STRING_VIEW_PRINTF_ARGS(token.lexeme), PHYTO_STRING_PRINTF_ARGS(literal));
     phyto_string_free(&literal);
 }
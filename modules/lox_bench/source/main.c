@@ -0,0 +1,343 @@
+#include <inttypes.h>
+#include <lox/ast_printer.h>
+#include <lox/lox.h>
+#include <lox/optimizer.h>
+#include <lox/parser.h>
+#include <lox/scanner.h>
+#include <phyto/bench/bench.h>
+#include <phyto/io/io.h>
+#include <phyto/string/string.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits/sysexits.h>
+
+#ifndef LOX_BENCH_CORPUS_DIR
+#define LOX_BENCH_CORPUS_DIR "corpus"
+#endif
+
+// each one is <name>.lox in the corpus directory
+static const char* const corpus[] = {
+    "fib",
+    "binary_trees",
+    "string_building",
+    "arithmetic_loop",
+};
+#define CORPUS_SIZE (sizeof(corpus) / sizeof(corpus[0]))
+
+// "execute" is everything after parsing: folding and printing the tree
+#define BENCH_PHASES_X \
+    X(scan)            \
+    X(parse)           \
+    X(execute)
+
+typedef enum {
+#define X(x) bench_phase_##x,
+    BENCH_PHASES_X
+#undef X
+    bench_phase_count,
+} bench_phase_t;
+
+static const char* const phase_names[] = {
+#define X(x) #x,
+    BENCH_PHASES_X
+#undef X
+};
+
+#define BENCH_PERCENTILES_X \
+    X(50)                   \
+    X(90)                   \
+    X(99)
+
+typedef enum {
+#define X(x) bench_p##x,
+    BENCH_PERCENTILES_X
+#undef X
+    bench_percentile_count,
+} bench_percentile_t;
+
+static const uint64_t percentiles[] = {
+#define X(x) x,
+    BENCH_PERCENTILES_X
+#undef X
+};
+
+typedef struct {
+    const char* name;
+    uint64_t ns[bench_phase_count][bench_percentile_count];
+} bench_result_t;
+
+typedef struct {
+    const char* corpus_dir;
+    const char* baseline_path;
+    size_t iterations;
+    size_t warmup;
+    double threshold;
+    bool json;
+} bench_options_t;
+
+static bool run_once(lox_context_t* ctx, phyto_string_span_t source, uint64_t* samples) {
+    uint64_t start = phyto_bench_now_ns();
+    lox_scanner_t scanner = lox_scanner_new(ctx, source);
+    lox_token_vec_t tokens = lox_scanner_scan_tokens(&scanner);
+    uint64_t scanned = phyto_bench_now_ns();
+    lox_parser_t parser = lox_parser_new(ctx, tokens, &ctx->arena);
+    lox_expr_t* expression = lox_parser_parse(&parser);
+    uint64_t parsed = phyto_bench_now_ns();
+    if (ctx->had_error) {
+        if (expression != NULL) {
+            lox_expr_free(expression);
+        }
+        phyto_arena_reset(&ctx->arena);
+        lox_scanner_free(&scanner);
+        return false;
+    }
+    expression = lox_optimize(expression, &ctx->arena, NULL);
+    phyto_string_t output = lox_print_ast(expression);
+    uint64_t executed = phyto_bench_now_ns();
+    phyto_string_free(&output);
+    lox_expr_free(expression);
+    phyto_arena_reset(&ctx->arena);
+    lox_scanner_free(&scanner);
+    samples[bench_phase_scan] = scanned - start;
+    samples[bench_phase_parse] = parsed - scanned;
+    samples[bench_phase_execute] = executed - parsed;
+    return true;
+}
+
+static int bench_program(const bench_options_t* options, bench_result_t* result) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s.lox", options->corpus_dir, result->name);
+    phyto_io_mapping_t source;
+    if (!phyto_io_map_file(path, &source)) {
+        phyto_io_unmap_file(&source);
+        fprintf(stderr, "Could not read file: %s\n", path);
+        return EX_NOINPUT;
+    }
+    uint64_t* samples[bench_phase_count];
+    int status = EX_OK;
+    for (size_t phase = 0; phase < bench_phase_count; ++phase) {
+        samples[phase] = calloc(options->iterations, sizeof(uint64_t));
+        if (samples[phase] == NULL) {
+            status = EX_OSERR;
+        }
+    }
+    lox_context_t ctx = {0};
+    for (size_t i = 0; i < options->warmup + options->iterations && status == EX_OK; ++i) {
+        uint64_t once[bench_phase_count];
+        if (!run_once(&ctx, phyto_io_mapping_as_span(source), once)) {
+            status = EX_DATAERR;
+        } else if (i >= options->warmup) {
+            for (size_t phase = 0; phase < bench_phase_count; ++phase) {
+                samples[phase][i - options->warmup] = once[phase];
+            }
+        }
+    }
+    for (size_t phase = 0; phase < bench_phase_count; ++phase) {
+        if (status == EX_OK) {
+            phyto_bench_sort(samples[phase], options->iterations);
+            for (size_t p = 0; p < bench_percentile_count; ++p) {
+                result->ns[phase][p] =
+                    phyto_bench_percentile(samples[phase], options->iterations, percentiles[p]);
+            }
+        }
+        free(samples[phase]);
+    }
+    lox_context_free(&ctx);
+    phyto_io_unmap_file(&source);
+    return status;
+}
+
+static void print_table(const bench_result_t* results, size_t count, FILE* stream) {
+    fprintf(stream, "%-16s %-8s", "program", "phase");
+    for (size_t p = 0; p < bench_percentile_count; ++p) {
+        char label[8];
+        snprintf(label, sizeof(label), "p%" PRIu64, percentiles[p]);
+        fprintf(stream, " %11s", label);
+    }
+    fprintf(stream, "\n");
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t phase = 0; phase < bench_phase_count; ++phase) {
+            fprintf(stream, "%-16s %-8s", results[i].name, phase_names[phase]);
+            for (size_t p = 0; p < bench_percentile_count; ++p) {
+                fprintf(stream, " %9.1fus", (double)results[i].ns[phase][p] / 1e3);
+            }
+            fprintf(stream, "\n");
+        }
+    }
+}
+
+// one program per line, so baselines diff cleanly and find_baseline() can stay simple
+static void print_json(const bench_options_t* options,
+                       const bench_result_t* results,
+                       size_t count,
+                       FILE* stream) {
+    fprintf(stream, "{\"iterations\": %zu, \"warmup\": %zu, \"programs\": {\n", options->iterations,
+            options->warmup);
+    for (size_t i = 0; i < count; ++i) {
+        fprintf(stream, "  \"%s\": {", results[i].name);
+        for (size_t phase = 0; phase < bench_phase_count; ++phase) {
+            fprintf(stream, "%s\"%s\": {", phase == 0 ? "" : ", ", phase_names[phase]);
+            for (size_t p = 0; p < bench_percentile_count; ++p) {
+                fprintf(stream, "%s\"p%" PRIu64 "\": %" PRIu64, p == 0 ? "" : ", ",
+                        percentiles[p], results[i].ns[phase][p]);
+            }
+            fprintf(stream, "}");
+        }
+        fprintf(stream, "}%s\n", i + 1 == count ? "" : ",");
+    }
+    fprintf(stream, "}}\n");
+}
+
+// reads back what print_json() writes; anything else is not a baseline
+static bool find_baseline(const char* baseline,
+                          const char* program,
+                          const char* phase,
+                          uint64_t* out_median) {
+    char key[256];
+    snprintf(key, sizeof(key), "\"%s\": {", program);
+    const char* line = strstr(baseline, key);
+    if (line == NULL) {
+        return false;
+    }
+    const char* end = strchr(line, '\n');
+    snprintf(key, sizeof(key), "\"%s\": {\"p50\": ", phase);
+    const char* entry = strstr(line, key);
+    if (entry == NULL || (end != NULL && entry > end)) {
+        return false;
+    }
+    char* number_end;
+    *out_median = strtoull(entry + strlen(key), &number_end, 10);
+    return number_end != entry + strlen(key);
+}
+
+// compares medians; returns how many of them regressed past the threshold
+static size_t compare(const bench_options_t* options,
+                      const bench_result_t* results,
+                      size_t count,
+                      const char* baseline,
+                      FILE* stream) {
+    size_t regressions = 0;
+    fprintf(stream, "%-16s %-8s %12s %12s %8s\n", "program", "phase", "baseline", "median",
+            "change");
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t phase = 0; phase < bench_phase_count; ++phase) {
+            uint64_t median = results[i].ns[phase][bench_p50];
+            uint64_t base;
+            if (!find_baseline(baseline, results[i].name, phase_names[phase], &base) ||
+                base == 0) {
+                fprintf(stream, "%-16s %-8s %12s %10.1fus %8s\n", results[i].name,
+                        phase_names[phase], "-", (double)median / 1e3, "new");
+                continue;
+            }
+            double change = 100.0 * ((double)median - (double)base) / (double)base;
+            bool regressed = change > options->threshold;
+            regressions += regressed;
+            fprintf(stream, "%-16s %-8s %10.1fus %10.1fus %+7.1f%%%s\n", results[i].name,
+                    phase_names[phase], (double)base / 1e3, (double)median / 1e3, change,
+                    regressed ? "  REGRESSION" : "");
+        }
+    }
+    return regressions;
+}
+
+static int usage(const char* argv0) {
+    printf("Usage: %s [--iterations=N] [--warmup=N] [--corpus=DIR] [--json]\n", argv0);
+    printf("       %*s [--compare=BASELINE.json] [--threshold=PERCENT] [program...]\n",
+           (int)strlen(argv0), "");
+    printf("Programs:");
+    for (size_t i = 0; i < CORPUS_SIZE; ++i) {
+        printf(" %s", corpus[i]);
+    }
+    printf("\n");
+    return EX_USAGE;
+}
+
+int main(int argc, char** argv) {
+    bench_options_t options = {
+        .corpus_dir = LOX_BENCH_CORPUS_DIR,
+        .baseline_path = NULL,
+        .iterations = 50,
+        .warmup = 5,
+        .threshold = 10.0,
+        .json = false,
+    };
+    int arg = 1;
+    for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; ++arg) {
+        const char* value = strchr(argv[arg], '=');
+        value = value != NULL ? value + 1 : "";
+        uint64_t number = 0;
+        if (strncmp(argv[arg], "--iterations=", 13) == 0) {
+            if (!phyto_bench_parse_u64(value, &number) || number == 0) {
+                return usage(argv[0]);
+            }
+            options.iterations = (size_t)number;
+        } else if (strncmp(argv[arg], "--warmup=", 9) == 0) {
+            if (!phyto_bench_parse_u64(value, &number)) {
+                return usage(argv[0]);
+            }
+            options.warmup = (size_t)number;
+        } else if (strncmp(argv[arg], "--corpus=", 9) == 0) {
+            options.corpus_dir = value;
+        } else if (strncmp(argv[arg], "--compare=", 10) == 0) {
+            options.baseline_path = value;
+        } else if (strncmp(argv[arg], "--threshold=", 12) == 0) {
+            char* end;
+            options.threshold = strtod(value, &end);
+            if (*value == '\0' || *end != '\0') {
+                return usage(argv[0]);
+            }
+        } else if (strcmp(argv[arg], "--json") == 0) {
+            options.json = true;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    bench_result_t results[CORPUS_SIZE];
+    size_t count = 0;
+    for (size_t i = 0; i < CORPUS_SIZE; ++i) {
+        bool selected = arg == argc;
+        for (int j = arg; j < argc && !selected; ++j) {
+            selected = strcmp(argv[j], corpus[i]) == 0;
+        }
+        if (selected) {
+            results[count++] = (bench_result_t){.name = corpus[i]};
+        }
+    }
+    if ((size_t)(argc - arg) > count) {
+        return usage(argv[0]);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        int status = bench_program(&options, &results[i]);
+        if (status != EX_OK) {
+            return status;
+        }
+    }
+    if (options.json) {
+        print_json(&options, results, count, stdout);
+    } else {
+        print_table(results, count, stdout);
+    }
+
+    if (options.baseline_path == NULL) {
+        return EX_OK;
+    }
+    phyto_string_t baseline = phyto_io_read_file(options.baseline_path);
+    if (baseline.size == 0) {
+        phyto_string_free(&baseline);
+        fprintf(stderr, "Could not read baseline: %s\n", options.baseline_path);
+        return EX_NOINPUT;
+    }
+    phyto_string_append(&baseline, '\0');
+    // the report goes to stderr so that --json output stays machine-readable
+    size_t regressions = compare(&options, results, count, baseline.data, stderr);
+    phyto_string_free(&baseline);
+    if (regressions > 0) {
+        fprintf(stderr, "%zu regression(s) over %.1f%%\n", regressions, options.threshold);
+        return EXIT_FAILURE;
+    }
+    return EX_OK;
+}
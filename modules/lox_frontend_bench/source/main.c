@@ -0,0 +1,359 @@
+#include <inttypes.h>
+#include <lox/ast.h>
+#include <lox/ast_printer.h>
+#include <lox/lox.h>
+#include <lox/parser.h>
+#include <lox/scanner.h>
+#include <phyto/bench/bench.h>
+#include <phyto/collections/alloc_stats.h>
+#include <phyto/string/string.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits/sysexits.h>
+
+// every shape is a balanced tree of binary operators over shape-specific leaves, so a source
+// can be as large as asked while the tree stays about log2 of its size deep
+#define SHAPES_X   \
+    X(comments)    \
+    X(keywords)    \
+    X(numbers)     \
+    X(nested)
+
+typedef enum {
+#define X(x) shape_##x,
+    SHAPES_X
+#undef X
+    shape_count,
+} shape_t;
+
+static const char* const shape_names[] = {
+#define X(x) #x,
+    SHAPES_X
+#undef X
+};
+
+typedef struct {
+    size_t size;
+    size_t depth;
+    size_t iterations;
+    uint64_t seed;
+    bool json;
+} options_t;
+
+typedef struct {
+    shape_t shape;
+    size_t bytes;
+    size_t tokens;
+    uint64_t nodes;
+    // medians over all iterations
+    uint64_t scan_ns;
+    uint64_t parse_ns;
+    uint64_t print_ns;
+    // negative when the build does not count allocations
+    double allocations_per_token;
+} result_t;
+
+static const char* pick(uint64_t* rng, const char* const* choices, size_t count) {
+    return choices[phyto_bench_random(rng) % count];
+}
+
+static const char* const comment_words[] = {
+    "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit",
+};
+// the parser has no variables yet, so there are no identifiers to parse. keywords still take
+// the scanner's identifier path before they are told apart
+static const char* const keyword_leaves[] = {"true", "false", "nil"};
+static const char* const nesting_prefixes[] = {"(", "-", "!"};
+static const char* const arithmetic_operators[] = {" + ", " - ", " * ", " / ", " < ", " >= "};
+static const char* const equality_operators[] = {" == ", " != "};
+
+static void emit_number(phyto_string_t* out, uint64_t* rng) {
+    char buffer[32];
+    uint64_t value = phyto_bench_random(rng);
+    if (value % 4 == 0) {
+        snprintf(buffer, sizeof(buffer), "%" PRIu64 ".%02" PRIu64, value % 100000, value % 97);
+    } else {
+        snprintf(buffer, sizeof(buffer), "%" PRIu64, value % 1000000);
+    }
+    phyto_string_append_c(out, buffer);
+}
+
+static void emit_leaf(phyto_string_t* out, const options_t* options, shape_t shape, uint64_t* rng) {
+    switch (shape) {
+        case shape_comments:
+            emit_number(out, rng);
+            phyto_string_append_c(out, " //");
+            for (size_t i = 0; i < 8; ++i) {
+                phyto_string_append(out, ' ');
+                phyto_string_append_c(out, pick(rng, comment_words, 8));
+            }
+            phyto_string_append(out, '\n');
+            break;
+        case shape_keywords:
+            phyto_string_append_c(out, pick(rng, keyword_leaves, 3));
+            break;
+        case shape_numbers:
+            emit_number(out, rng);
+            break;
+        case shape_nested: {
+            size_t open = 0;
+            for (size_t i = 0; i < options->depth; ++i) {
+                const char* prefix = pick(rng, nesting_prefixes, 3);
+                open += prefix[0] == '(';
+                phyto_string_append_c(out, prefix);
+            }
+            emit_number(out, rng);
+            phyto_string_append_fill(out, open, ')');
+            break;
+        }
+        case shape_count:
+            break;
+    }
+}
+
+static void emit_tree(phyto_string_t* out,
+                      const options_t* options,
+                      shape_t shape,
+                      uint64_t* rng,
+                      size_t levels) {
+    if (levels == 0) {
+        emit_leaf(out, options, shape, rng);
+        return;
+    }
+    phyto_string_append(out, '(');
+    emit_tree(out, options, shape, rng, levels - 1);
+    if (shape == shape_keywords) {
+        phyto_string_append_c(out, pick(rng, equality_operators, 2));
+    } else {
+        phyto_string_append_c(out, pick(rng, arithmetic_operators, 6));
+    }
+    emit_tree(out, options, shape, rng, levels - 1);
+    phyto_string_append(out, ')');
+}
+
+// the smallest complete tree that reaches the requested size
+static phyto_string_t generate(const options_t* options, shape_t shape) {
+    phyto_string_t source = phyto_string_new();
+    for (size_t levels = 0; source.size < options->size; ++levels) {
+        uint64_t rng = options->seed;
+        source.size = 0;
+        emit_tree(&source, options, shape, &rng, levels);
+    }
+    return source;
+}
+
+// lox_stats_count_nodes() only exists in LOX_STATS builds, and this counts every build
+typedef struct {
+    uint64_t nodes;
+} bench_node_tally_t;
+
+LOX_EXPR_VISITOR_DECL(bench, node_tally, bool);
+LOX_EXPR_VISITOR_IMPL(bench, node_tally, bool);
+
+LOX_EXPR_VISITOR_VISIT_BINARY_FUNC(bench, node_tally, bool) {
+    visitor->nodes++;
+    return lox_expr_accept_node_tally(node->left, visitor) &&
+           lox_expr_accept_node_tally(node->right, visitor);
+}
+
+LOX_EXPR_VISITOR_VISIT_GROUPING_FUNC(bench, node_tally, bool) {
+    visitor->nodes++;
+    return lox_expr_accept_node_tally(node->expression, visitor);
+}
+
+LOX_EXPR_VISITOR_VISIT_LITERAL_FUNC(bench, node_tally, bool) {
+    (void)node;
+    visitor->nodes++;
+    return true;
+}
+
+LOX_EXPR_VISITOR_VISIT_UNARY_FUNC(bench, node_tally, bool) {
+    visitor->nodes++;
+    return lox_expr_accept_node_tally(node->right, visitor);
+}
+
+static uint64_t allocation_count(void) {
+    uint64_t count = 0;
+    for (const phyto_alloc_stats_t* s = phyto_alloc_stats_first(); s != NULL; s = s->next) {
+        count += s->allocations + s->reallocations;
+    }
+    return count;
+}
+
+static bool bench_shape(const options_t* options, result_t* result) {
+    phyto_string_t source = generate(options, result->shape);
+    result->bytes = source.size;
+    uint64_t* samples = calloc(options->iterations * 3, sizeof(uint64_t));
+    if (samples == NULL) {
+        phyto_string_free(&source);
+        return false;
+    }
+    uint64_t* scan = samples;
+    uint64_t* parse = samples + options->iterations;
+    uint64_t* print = samples + options->iterations * 2;
+    lox_context_t ctx = {0};
+    bool ok = true;
+    for (size_t i = 0; i < options->iterations && ok; ++i) {
+        uint64_t allocations = allocation_count();
+        uint64_t start = phyto_bench_now_ns();
+        lox_scanner_t scanner = lox_scanner_new(&ctx, phyto_string_as_span(source));
+        lox_token_vec_t tokens = lox_scanner_scan_tokens(&scanner);
+        uint64_t scanned = phyto_bench_now_ns();
+        lox_parser_t parser = lox_parser_new(&ctx, tokens, &ctx.arena);
+        lox_expr_t* expression = lox_parser_parse(&parser);
+        uint64_t parsed = phyto_bench_now_ns();
+        ok = !ctx.had_error;
+        if (ok) {
+            phyto_string_t output = lox_print_ast(expression);
+            uint64_t printed = phyto_bench_now_ns();
+            phyto_string_free(&output);
+            scan[i] = scanned - start;
+            parse[i] = parsed - scanned;
+            print[i] = printed - parsed;
+            result->tokens = tokens.size;
+            bench_node_tally_t tally = {0};
+            lox_expr_accept_node_tally(expression, &tally);
+            result->nodes = tally.nodes;
+        }
+#ifdef PHYTO_ALLOC_STATS
+        result->allocations_per_token =
+            (double)(allocation_count() - allocations) / (double)tokens.size;
+#else
+        (void)allocations;
+        result->allocations_per_token = -1.0;
+#endif
+        if (expression != NULL) {
+            lox_expr_free(expression);
+        }
+        phyto_arena_reset(&ctx.arena);
+        lox_scanner_free(&scanner);
+    }
+    if (ok) {
+        result->scan_ns = phyto_bench_median(scan, options->iterations);
+        result->parse_ns = phyto_bench_median(parse, options->iterations);
+        result->print_ns = phyto_bench_median(print, options->iterations);
+    }
+    free(samples);
+    lox_context_free(&ctx);
+    phyto_string_free(&source);
+    return ok;
+}
+
+static double per_second(double amount, uint64_t ns) {
+    return ns == 0 ? 0.0 : amount * 1e9 / (double)ns;
+}
+
+static void print_table(const result_t* results, size_t count, FILE* stream) {
+    fprintf(stream, "%-12s %10s %10s %10s %14s %14s %12s\n", "shape", "bytes", "tokens",
+            "scan MB/s", "parse tok/s", "print node/s", "allocs/tok");
+    for (size_t i = 0; i < count; ++i) {
+        const result_t* r = &results[i];
+        fprintf(stream, "%-12s %10zu %10zu %10.1f %14.0f %14.0f ", shape_names[r->shape], r->bytes,
+                r->tokens, per_second((double)r->bytes / 1e6, r->scan_ns),
+                per_second((double)r->tokens, r->parse_ns),
+                per_second((double)r->nodes, r->print_ns));
+        if (r->allocations_per_token < 0) {
+            fprintf(stream, "%12s\n", "-");
+        } else {
+            fprintf(stream, "%12.3f\n", r->allocations_per_token);
+        }
+    }
+}
+
+static void print_json(const options_t* options,
+                       const result_t* results,
+                       size_t count,
+                       FILE* stream) {
+    fprintf(stream, "{\"seed\": %" PRIu64 ", \"iterations\": %zu, \"shapes\": {\n", options->seed,
+            options->iterations);
+    for (size_t i = 0; i < count; ++i) {
+        const result_t* r = &results[i];
+        fprintf(stream,
+                "  \"%s\": {\"bytes\": %zu, \"tokens\": %zu, \"nodes\": %" PRIu64
+                ", \"scan_mb_per_s\": %.3f, \"parse_tokens_per_s\": %.0f"
+                ", \"print_nodes_per_s\": %.0f, \"allocations_per_token\": ",
+                shape_names[r->shape], r->bytes, r->tokens, r->nodes,
+                per_second((double)r->bytes / 1e6, r->scan_ns),
+                per_second((double)r->tokens, r->parse_ns),
+                per_second((double)r->nodes, r->print_ns));
+        if (r->allocations_per_token < 0) {
+            fprintf(stream, "null");
+        } else {
+            fprintf(stream, "%.3f", r->allocations_per_token);
+        }
+        fprintf(stream, "}%s\n", i + 1 == count ? "" : ",");
+    }
+    fprintf(stream, "}}\n");
+}
+
+static int usage(const char* argv0) {
+    printf("Usage: %s [--size=BYTES] [--depth=N] [--iterations=N] [--seed=N] [--json] [shape...]\n",
+           argv0);
+    printf("Shapes:");
+    for (size_t i = 0; i < shape_count; ++i) {
+        printf(" %s", shape_names[i]);
+    }
+    printf("\n");
+    return EX_USAGE;
+}
+
+int main(int argc, char** argv) {
+    options_t options = {
+        .size = 1 << 18,
+        .depth = 64,
+        .iterations = 5,
+        .seed = 0x10c5eed,
+        .json = false,
+    };
+    int arg = 1;
+    for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; ++arg) {
+        const char* value = strchr(argv[arg], '=');
+        value = value != NULL ? value + 1 : "";
+        uint64_t number = 0;
+        if (strcmp(argv[arg], "--json") == 0) {
+            options.json = true;
+        } else if (!phyto_bench_parse_u64(value, &number)) {
+            return usage(argv[0]);
+        } else if (strncmp(argv[arg], "--size=", 7) == 0) {
+            options.size = (size_t)number;
+        } else if (strncmp(argv[arg], "--depth=", 8) == 0) {
+            options.depth = (size_t)number;
+        } else if (strncmp(argv[arg], "--iterations=", 13) == 0 && number > 0) {
+            options.iterations = (size_t)number;
+        } else if (strncmp(argv[arg], "--seed=", 7) == 0 && number != 0) {
+            options.seed = number;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    result_t results[shape_count];
+    size_t count = 0;
+    for (size_t i = 0; i < shape_count; ++i) {
+        bool selected = arg == argc;
+        for (int j = arg; j < argc && !selected; ++j) {
+            selected = strcmp(argv[j], shape_names[i]) == 0;
+        }
+        if (selected) {
+            results[count++] = (result_t){.shape = (shape_t)i};
+        }
+    }
+    if ((size_t)(argc - arg) > count) {
+        return usage(argv[0]);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!bench_shape(&options, &results[i])) {
+            fprintf(stderr, "The %s source did not parse\n", shape_names[results[i].shape]);
+            return EX_SOFTWARE;
+        }
+    }
+    if (options.json) {
+        print_json(&options, results, count, stdout);
+    } else {
+        print_table(results, count, stdout);
+    }
+    return EX_OK;
+}
@@ -311,6 +311,10 @@ static void dump_types(phyto_string_span_t tree_name, nodes_t nodes, FILE* outpu
     fprintf(output, "} ");
     print_discriminator_type_name(tree_name, output);
     fprintf(output, ";\n");
+    phyto_string_t tree_name_upper = phyto_string_upper(tree_name);
+    fprintf(output, "#define " NS_UPPER "_%" STR_FMT "_TYPE_COUNT %zu\n", STR_PRN(tree_name_upper),
+            nodes.size);
+    phyto_string_free(&tree_name_upper);
     fprintf(output, "typedef struct {\n");
     fprintf(output, "    ");
     print_discriminator_type_name(tree_name, output);
@@ -448,7 +452,9 @@ static void dump_toplevel_source_macro(phyto_string_span_t tree_name, nodes_t no
 static void print_constructor_signature(phyto_string_span_t tree_name, node_t* node, FILE* output) {
     print_derived_type_name(tree_name, node->name, output);
     fprintf(output, "* " NS "_%" SP_FMT "_new_%" SP_FMT "(", SP_PRN(tree_name), SP_PRN(node->name));
+    fprintf(output, "phyto_arena_t* arena");
     for (size_t j = 0; j < node->fields.size; ++j) {
+        fprintf(output, ", ");
         phyto_string_t field_type =
             phyto_string_span_equal(phyto_string_as_span(node->fields.data[j].type), tree_name)
                 ? phyto_string_from_sprintf(NS "_%" SP_FMT "_t*", SP_PRN(tree_name))
@@ -456,9 +462,6 @@ static void print_constructor_signature(phyto_string_span_t tree_name, node_t* n
         fprintf(output, "%" STR_FMT " %" SP_FMT, STR_PRN(field_type),
                 SP_PRN(node->fields.data[j].name));
         phyto_string_free(&field_type);
-        if (j < node->fields.size - 1) {
-            fprintf(output, ", ");
-        }
     }
     fprintf(output, ")");
 }
@@ -469,9 +472,17 @@ static void print_free_fn_signature(phyto_string_span_t tree_name, FILE* output)
     fprintf(output, "* node)");
 }
 
+static void print_type_name_fn_signature(phyto_string_span_t tree_name, FILE* output) {
+    fprintf(output, "const char* " NS "_%" SP_FMT "_type_name(", SP_PRN(tree_name));
+    print_discriminator_type_name(tree_name, output);
+    fprintf(output, " type)");
+}
+
 static void dump_source_file_decls(phyto_string_span_t tree_name, nodes_t nodes, FILE* output) {
     print_free_fn_signature(tree_name, output);
     fprintf(output, ";\n");
+    print_type_name_fn_signature(tree_name, output);
+    fprintf(output, ";\n");
     for (size_t i = 0; i < nodes.size; ++i) {
         print_constructor_signature(tree_name, &nodes.data[i], output);
         fprintf(output, ";\n");
@@ -536,23 +547,20 @@ static void dump_constructors(phyto_string_span_t tree_name, nodes_t nodes, FILE
         node_t* node = &nodes.data[i];
         print_derived_type_name(tree_name, node->name, output);
         fprintf(output, "* " NS "_%" SP_FMT "_new_%" SP_FMT, SP_PRN(tree_name), SP_PRN(node->name));
-        fprintf(output, "(");
+        fprintf(output, "(phyto_arena_t* arena");
         for (size_t j = 0; j < node->fields.size; ++j) {
             field_t* field = &node->fields.data[j];
             phyto_string_t field_type =
                 phyto_string_span_equal(phyto_string_as_span(field->type), tree_name)
                     ? phyto_string_from_sprintf(NS "_%" SP_FMT "_t*", SP_PRN(tree_name))
                     : phyto_string_copy(field->type);
-            fprintf(output, "%" STR_FMT " %" SP_FMT, STR_PRN(field_type), SP_PRN(field->name));
+            fprintf(output, ", %" STR_FMT " %" SP_FMT, STR_PRN(field_type), SP_PRN(field->name));
             phyto_string_free(&field_type);
-            if (j < node->fields.size - 1) {
-                fprintf(output, ", ");
-            }
         }
         fprintf(output, ") {\n");
         fprintf(output, "    ");
         print_derived_type_name(tree_name, node->name, output);
-        fprintf(output, "* node = calloc(1, sizeof(");
+        fprintf(output, "* node = phyto_arena_alloc(arena, sizeof(");
         print_derived_type_name(tree_name, node->name, output);
         fprintf(output, "));\n");
         fprintf(output, "    node->base.type = " NS "_%" SP_FMT "_type_%" SP_FMT ";\n",
@@ -590,7 +598,17 @@ static void dump_source_file(phyto_string_span_t tree_name,
         fprintf(output, "            break;\n");
     }
     fprintf(output, "    }\n");
-    fprintf(output, "    free(node);\n");
+    // node memory belongs to the arena it was allocated from
+    fprintf(output, "}\n");
+
+    print_type_name_fn_signature(tree_name, output);
+    fprintf(output, " {\n");
+    fprintf(output, "    static const char* const names[] = {\n");
+    for (size_t i = 0; i < nodes.size; ++i) {
+        fprintf(output, "        \"%" SP_FMT "\",\n", SP_PRN(nodes.data[i].name));
+    }
+    fprintf(output, "    };\n");
+    fprintf(output, "    return names[type];\n");
     fprintf(output, "}\n");
 
     dump_constructors(tree_name, nodes, output);
@@ -611,6 +629,7 @@ static void parse_def(parser_t* p,
 
     fprintf(header_output, "#ifndef " NS_UPPER "_AST_H_\n");
     fprintf(header_output, "#define " NS_UPPER "_AST_H_\n");
+    fprintf(header_output, "#include <phyto/arena/arena.h>\n");
 
     nodes_t nodes = nodes_init(&nodes_callbacks);
     while (current(p)->type != ttype_end) {
@@ -0,0 +1,97 @@
+#include <inttypes.h>
+#include <lox/ast_printer.h>
+#include <lox/lox.h>
+#include <lox/optimizer.h>
+#include <lox/parser.h>
+#include <lox/scanner.h>
+#include <phyto/string/string.h>
+#include <phyto/test/test.h>
+#include <stdio.h>
+#include <string.h>
+
+// scans, parses and folds `source`, then prints what is left of the tree
+static phyto_string_t fold(const char* source) {
+    lox_context_t ctx = {0};
+    lox_scanner_t scanner = lox_scanner_new(&ctx, phyto_string_span_from_c(source));
+    lox_token_vec_t tokens = lox_scanner_scan_tokens(&scanner);
+    lox_parser_t parser = lox_parser_new(&ctx, tokens, &ctx.arena);
+    lox_expr_t* expression = lox_parser_parse(&parser);
+    phyto_string_t result = phyto_string_from_c("<parse error>");
+    if (!ctx.had_error) {
+        phyto_string_free(&result);
+        expression = lox_optimize(expression, &ctx.arena, NULL);
+        result = lox_print_ast(expression);
+    }
+    if (expression != NULL) {
+        lox_expr_free(expression);
+    }
+    lox_scanner_free(&scanner);
+    lox_context_free(&ctx);
+    return result;
+}
+
+static PHYTO_TEST_SUBTEST_FUNC(folds_to, const char* source, const char* expected) {
+    phyto_string_t actual = fold(source);
+    PHYTO_TEST_ASSERT(phyto_string_span_equal(phyto_string_as_span(actual),
+                                              phyto_string_span_from_c(expected)),
+                      phyto_string_free(&actual), "%s folded to %" PHYTO_STRING_FORMAT ", not %s",
+                      source, PHYTO_STRING_PRINTF_ARGS(actual), expected);
+    phyto_string_free(&actual);
+    PHYTO_TEST_SUBTEST_PASS();
+}
+
+static PHYTO_TEST_FUNC(integers) {
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "1 + 2 * 3", "7");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "6 / -3", "-2");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "7 / 2", "3.5");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "9223372036854775807 + 1", "9.22337e+18");
+    PHYTO_TEST_PASS();
+}
+
+static PHYTO_TEST_FUNC(negative_zero) {
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "-0", "-0");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "0 * -1", "-0");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "-5 * 0", "-0");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "0 / -5", "-0");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "-0 * 1", "-0");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "0 * 5", "0");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "-5 * -0", "0");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "0 - 0", "0");
+    PHYTO_TEST_PASS();
+}
+
+// integers must print and compare exactly like the doubles they stand in for
+static PHYTO_TEST_FUNC(double_compatible) {
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "1000000", "1e+06");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "1000000.0", "1e+06");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "999999 + 1", "1e+06");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "9007199254740993 == 9007199254740992", "true");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "9007199254740992 + 1 == 9007199254740992", "true");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "-9007199254740992 - 1 == -9007199254740992",
+                           "true");
+    PHYTO_TEST_PASS();
+}
+
+// short literals are parsed from a stack copy, longer ones from a heap copy
+static PHYTO_TEST_FUNC(fractional_literals) {
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0, "0.5 + 0.25", "0.75");
+    PHYTO_TEST_RUN_SUBTEST(folds_to, (void)0,
+                           "1.000000000000000000000000000000000000000000000000000000000000000000001",
+                           "1");
+    PHYTO_TEST_PASS();
+}
+
+static PHYTO_TEST_SUITE_FUNC(optimizer) {
+    PHYTO_TEST_RUN(integers);
+    PHYTO_TEST_RUN(negative_zero);
+    PHYTO_TEST_RUN(double_compatible);
+    PHYTO_TEST_RUN(fractional_literals);
+}
+
+int main(void) {
+    phyto_test_state_t state = {0};
+    PHYTO_TEST_RUN_SUITE(optimizer, &state);
+    printf("%" PRIu64 " tests, %" PRIu64 " failures, %" PRIu64 " assertions\n",
+           state.tests_passed + state.tests_failed, state.tests_failed, state.assert_count);
+    return (int)state.tests_failed;
+}
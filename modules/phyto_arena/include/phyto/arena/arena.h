@@ -0,0 +1,25 @@
+#ifndef PHYTO_ARENA_ARENA_H_
+#define PHYTO_ARENA_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// A bump allocator. Allocations are carved out of large blocks and are never
+// freed individually; the whole arena is released (or reset for reuse) at once.
+// A zero-initialized arena is valid and uses the default block size.
+typedef struct phyto_arena_block_s phyto_arena_block_t;
+
+typedef struct {
+    phyto_arena_block_t* head;
+    size_t block_size;
+} phyto_arena_t;
+
+extern const size_t phyto_arena_default_block_size;
+
+phyto_arena_t phyto_arena_new(size_t block_size);
+void* phyto_arena_alloc(phyto_arena_t* arena, size_t size);
+void phyto_arena_reset(phyto_arena_t* arena);
+void phyto_arena_free(phyto_arena_t* arena);
+size_t phyto_arena_used(phyto_arena_t* arena);
+
+#endif  // PHYTO_ARENA_ARENA_H_
@@ -0,0 +1,107 @@
+#include "phyto/arena/arena.h"
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct phyto_arena_block_s {
+    phyto_arena_block_t* next;
+    size_t capacity;
+    size_t used;
+    alignas(max_align_t) unsigned char data[];
+};
+
+const size_t phyto_arena_default_block_size = 16 * 1024;
+
+static size_t align_up(size_t size) {
+    const size_t align = alignof(max_align_t);
+    return (size + align - 1) & ~(align - 1);
+}
+
+static phyto_arena_block_t* new_block(size_t capacity, phyto_arena_block_t* next) {
+    phyto_arena_block_t* block = malloc(sizeof(phyto_arena_block_t) + capacity);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->next = next;
+    block->capacity = capacity;
+    block->used = 0;
+    return block;
+}
+
+phyto_arena_t phyto_arena_new(size_t block_size) {
+    return (phyto_arena_t){
+        .head = NULL,
+        .block_size = block_size,
+    };
+}
+
+void* phyto_arena_alloc(phyto_arena_t* arena, size_t size) {
+    size = align_up(size == 0 ? 1 : size);
+    phyto_arena_block_t* block = arena->head;
+    if (block == NULL || block->capacity - block->used < size) {
+        size_t block_size =
+            arena->block_size == 0 ? phyto_arena_default_block_size : arena->block_size;
+        if (size > block_size / 4) {
+            // big allocations get a block of their own, behind the current one, so
+            // the space left in the current block isn't wasted
+            phyto_arena_block_t* big = new_block(size, NULL);
+            if (big == NULL) {
+                return NULL;
+            }
+            big->used = size;
+            if (block == NULL) {
+                arena->head = big;
+            } else {
+                big->next = block->next;
+                block->next = big;
+            }
+            memset(big->data, 0, size);
+            return big->data;
+        }
+        block = new_block(block_size, block);
+        if (block == NULL) {
+            return NULL;
+        }
+        arena->head = block;
+    }
+    void* result = block->data + block->used;
+    block->used += size;
+    memset(result, 0, size);
+    return result;
+}
+
+void phyto_arena_reset(phyto_arena_t* arena) {
+    if (arena->head == NULL) {
+        return;
+    }
+    // keep the newest block around for the next round of allocations
+    phyto_arena_block_t* block = arena->head->next;
+    while (block != NULL) {
+        phyto_arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head->next = NULL;
+    arena->head->used = 0;
+}
+
+void phyto_arena_free(phyto_arena_t* arena) {
+    phyto_arena_block_t* block = arena->head;
+    while (block != NULL) {
+        phyto_arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+}
+
+size_t phyto_arena_used(phyto_arena_t* arena) {
+    size_t used = 0;
+    for (phyto_arena_block_t* block = arena->head; block != NULL; block = block->next) {
+        used += block->used;
+    }
+    return used;
+}
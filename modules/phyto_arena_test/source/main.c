@@ -0,0 +1,84 @@
+#include <inttypes.h>
+#include <phyto/arena/arena.h>
+#include <phyto/test/test.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+
+static PHYTO_TEST_FUNC(alloc) {
+    phyto_arena_t arena = phyto_arena_new(256);
+    char* a = phyto_arena_alloc(&arena, 3);
+    PHYTO_TEST_ASSERT(a != NULL, phyto_arena_free(&arena), "phyto_arena_alloc() failed");
+    double* b = phyto_arena_alloc(&arena, sizeof(double));
+    PHYTO_TEST_ASSERT(b != NULL, phyto_arena_free(&arena), "phyto_arena_alloc() failed");
+    PHYTO_TEST_ASSERT((uintptr_t)b % alignof(max_align_t) == 0, phyto_arena_free(&arena),
+                      "allocation was not aligned");
+    PHYTO_TEST_ASSERT(a[0] == 0 && a[1] == 0 && a[2] == 0 && *b == 0, phyto_arena_free(&arena),
+                      "allocation was not zeroed");
+    phyto_arena_free(&arena);
+    PHYTO_TEST_PASS();
+}
+
+static PHYTO_TEST_FUNC(many) {
+    phyto_arena_t arena = {0};
+    int* values[1000];
+    for (int i = 0; i < 1000; ++i) {
+        values[i] = phyto_arena_alloc(&arena, sizeof(int));
+        PHYTO_TEST_ASSERT(values[i] != NULL, phyto_arena_free(&arena),
+                          "phyto_arena_alloc() failed");
+        *values[i] = i;
+    }
+    for (int i = 0; i < 1000; ++i) {
+        PHYTO_TEST_ASSERT(*values[i] == i, phyto_arena_free(&arena), "values[%d] == %d", i,
+                          *values[i]);
+    }
+    phyto_arena_free(&arena);
+    PHYTO_TEST_PASS();
+}
+
+static PHYTO_TEST_FUNC(big) {
+    phyto_arena_t arena = phyto_arena_new(256);
+    char* small = phyto_arena_alloc(&arena, 16);
+    char* big = phyto_arena_alloc(&arena, 4096);
+    char* after = phyto_arena_alloc(&arena, 16);
+    PHYTO_TEST_ASSERT(small != NULL && big != NULL && after != NULL, phyto_arena_free(&arena),
+                      "phyto_arena_alloc() failed");
+    memset(big, 'x', 4096);
+    PHYTO_TEST_ASSERT(after == small + 16, phyto_arena_free(&arena),
+                      "big allocation wasted the current block");
+    PHYTO_TEST_ASSERT(phyto_arena_used(&arena) == 4096 + 32, phyto_arena_free(&arena),
+                      "phyto_arena_used() == %zu", phyto_arena_used(&arena));
+    phyto_arena_free(&arena);
+    PHYTO_TEST_PASS();
+}
+
+static PHYTO_TEST_FUNC(reset) {
+    phyto_arena_t arena = phyto_arena_new(256);
+    for (int i = 0; i < 100; ++i) {
+        phyto_arena_alloc(&arena, 32);
+    }
+    phyto_arena_reset(&arena);
+    PHYTO_TEST_ASSERT(phyto_arena_used(&arena) == 0, phyto_arena_free(&arena),
+                      "phyto_arena_used() == %zu after reset", phyto_arena_used(&arena));
+    void* head = arena.head;
+    phyto_arena_alloc(&arena, 32);
+    PHYTO_TEST_ASSERT(arena.head == head, phyto_arena_free(&arena),
+                      "reset did not keep a block for reuse");
+    phyto_arena_free(&arena);
+    PHYTO_TEST_PASS();
+}
+
+static PHYTO_TEST_SUITE_FUNC(arena) {
+    PHYTO_TEST_RUN(alloc);
+    PHYTO_TEST_RUN(many);
+    PHYTO_TEST_RUN(big);
+    PHYTO_TEST_RUN(reset);
+}
+
+int main(void) {
+    phyto_test_state_t state = {0};
+    PHYTO_TEST_RUN_SUITE(arena, &state);
+    printf("%" PRIu64 " tests, %" PRIu64 " failures, %" PRIu64 " assertions\n",
+           state.tests_passed + state.tests_failed, state.tests_failed, state.assert_count);
+    return (int)state.tests_failed;
+}
@@ -0,0 +1,22 @@
+#ifndef PHYTO_BENCH_BENCH_H_
+#define PHYTO_BENCH_BENCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// the helpers every benchmark executable needs, so they all time and summarize the same way
+
+// monotonic, in nanoseconds
+uint64_t phyto_bench_now_ns(void);
+// xorshift64, so a seed always produces the same sequence. the state must not be 0
+uint64_t phyto_bench_random(uint64_t* state);
+void phyto_bench_sort(uint64_t* samples, size_t count);
+// nearest rank on samples already sorted by phyto_bench_sort()
+uint64_t phyto_bench_percentile(const uint64_t* sorted, size_t count, uint64_t pct);
+// sorts the samples in place
+uint64_t phyto_bench_median(uint64_t* samples, size_t count);
+// a decimal number and nothing else
+bool phyto_bench_parse_u64(const char* text, uint64_t* out);
+
+#endif  // PHYTO_BENCH_BENCH_H_
@@ -0,0 +1,44 @@
+#include "phyto/bench/bench.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+uint64_t phyto_bench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+uint64_t phyto_bench_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t lhs = *(const uint64_t*)a;
+    uint64_t rhs = *(const uint64_t*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+void phyto_bench_sort(uint64_t* samples, size_t count) {
+    qsort(samples, count, sizeof(uint64_t), compare_u64);
+}
+
+uint64_t phyto_bench_percentile(const uint64_t* sorted, size_t count, uint64_t pct) {
+    return sorted[(count - 1) * pct / 100];
+}
+
+uint64_t phyto_bench_median(uint64_t* samples, size_t count) {
+    phyto_bench_sort(samples, count);
+    return samples[count / 2];
+}
+
+bool phyto_bench_parse_u64(const char* text, uint64_t* out) {
+    char* end;
+    *out = strtoull(text, &end, 10);
+    return *text != '\0' && *end == '\0';
+}
@@ -0,0 +1,43 @@
+#ifndef PHYTO_COLLECTIONS_ALLOC_STATS_H_
+#define PHYTO_COLLECTIONS_ALLOC_STATS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// one record per container type, e.g. every phyto_string_t shares one
+typedef struct phyto_alloc_stats {
+    const char* name;
+    // sum of every size passed to malloc, calloc or realloc
+    uint64_t bytes_allocated;
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+    uint64_t allocations;
+    uint64_t reallocations;
+    uint64_t frees;
+    // capacity that was never filled by the time its buffer was released
+    uint64_t wasted_bytes;
+    bool registered;
+    struct phyto_alloc_stats* next;
+} phyto_alloc_stats_t;
+
+// a buffer of old_bytes became new_bytes; 0 on either side means malloc or free
+void phyto_alloc_stats_record(phyto_alloc_stats_t* stats, size_t old_bytes, size_t new_bytes);
+void phyto_alloc_stats_waste(phyto_alloc_stats_t* stats, size_t bytes);
+// records appear once their container type first allocates; NULL if none has
+const phyto_alloc_stats_t* phyto_alloc_stats_first(void);
+void phyto_alloc_stats_print(FILE* stream);
+
+// the containers only report in builds configured with -DPHYTO_ALLOC_STATS=ON
+#ifdef PHYTO_ALLOC_STATS
+#define PHYTO_ALLOC_STATS_DEFINE(Sym, Label) static phyto_alloc_stats_t Sym = {.name = Label};
+#define PHYTO_ALLOC_STATS_RECORD(Sym, Old, New) phyto_alloc_stats_record(&(Sym), (Old), (New))
+#define PHYTO_ALLOC_STATS_WASTE(Sym, Bytes) phyto_alloc_stats_waste(&(Sym), (Bytes))
+#else
+#define PHYTO_ALLOC_STATS_DEFINE(Sym, Label)
+#define PHYTO_ALLOC_STATS_RECORD(Sym, Old, New) ((void)0)
+#define PHYTO_ALLOC_STATS_WASTE(Sym, Bytes) ((void)0)
+#endif
+
+#endif  // PHYTO_COLLECTIONS_ALLOC_STATS_H_
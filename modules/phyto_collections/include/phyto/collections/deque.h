@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "phyto/collections/alloc_stats.h"
 #include "phyto/collections/callbacks.h"
 
 #define PHYTO_COLLECTIONS_DEQUE_ERROR_FLAGS_X \
@@ -69,6 +70,7 @@ typedef enum {
     void Name##_print(Name##_t deque, FILE* stream, const char* sep);
 
 #define PHYTO_COLLECTIONS_DEQUE_IMPL(Name, V)                                                     \
+    PHYTO_ALLOC_STATS_DEFINE(Name##_alloc_stats, #Name)                                           \
     Name##_t Name##_new(size_t capacity, const Name##_callbacks_t* callbacks) {                   \
         if (capacity < 1) {                                                                       \
             return (Name##_t){.error_flag = phyto_deque_error_flag_invalid};                      \
@@ -82,6 +84,7 @@ typedef enum {
             deque.error_flag = phyto_deque_error_flag_alloc;                                      \
             return deque;                                                                         \
         }                                                                                         \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, 0, capacity * sizeof(V));                    \
         deque.capacity = capacity;                                                                \
         deque.count = 0;                                                                          \
         deque.front = 0;                                                                          \
@@ -109,6 +112,9 @@ typedef enum {
                 i = (i + 1) % deque->capacity;                                                    \
             }                                                                                     \
         }                                                                                         \
+        PHYTO_ALLOC_STATS_WASTE(Name##_alloc_stats,                                               \
+                                (deque->capacity - deque->count) * sizeof(V));                    \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, deque->capacity * sizeof(V), 0);             \
         free(deque->data);                                                                        \
         deque->data = NULL;                                                                       \
         deque->capacity = 0;                                                                      \
@@ -177,7 +183,7 @@ typedef enum {
             return (V){0};                                                                        \
         }                                                                                         \
         deque->error_flag = phyto_deque_error_flag_ok;                                            \
-        return deque->data[deque->back - 1];                                                      \
+        return deque->data[(deque->back == 0 ? deque->capacity : deque->back) - 1];               \
     }                                                                                             \
     bool Name##_contains(Name##_t* deque, V value) {                                              \
         bool result = false;                                                                      \
@@ -209,6 +215,8 @@ typedef enum {
             new_data[j] = deque->data[i];                                                         \
             i = (i + 1) % deque->capacity;                                                        \
         }                                                                                         \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, deque->capacity * sizeof(V),                 \
+                                 capacity * sizeof(V));                                           \
         free(deque->data);                                                                        \
         deque->data = new_data;                                                                   \
         deque->capacity = capacity;                                                               \
@@ -296,3 +304,107 @@ typedef enum {
     }
 
 #endif  // PHYTO_DEQUE_DEQUE_H_
+
+// the concurrent deque needs pthreads, so only translation units that define
+// PHYTO_COLLECTIONS_CONCURRENT before including this header get it
+#if defined(PHYTO_COLLECTIONS_CONCURRENT) && !defined(PHYTO_DEQUE_CONCURRENT_H_)
+#define PHYTO_DEQUE_CONCURRENT_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+// A deque of Inner (declared with PHYTO_COLLECTIONS_DEQUE_DECL) guarded by a mutex, for
+// work stealing: the owning thread pushes and pops at the back, other threads steal from
+// the front, so the owner works newest-first while thieves take the oldest work. The error
+// flag is atomic, since a failed lock has to report without holding the mutex. A mutex
+// must not be copied, so the deque is initialized in place rather than returned by value.
+#define PHYTO_COLLECTIONS_CONCURRENT_DEQUE_DECL(Name, Inner, V)                               \
+    typedef struct {                                                                          \
+        Inner##_t deque;                                                                      \
+        pthread_mutex_t mutex;                                                                \
+        _Atomic phyto_deque_error_flag_t error_flag;                                          \
+    } Name##_t;                                                                               \
+                                                                                              \
+    bool Name##_init(Name##_t* deque, size_t capacity, const Inner##_callbacks_t* callbacks); \
+    void Name##_free(Name##_t* deque);                                                        \
+    bool Name##_push(Name##_t* deque, V value);                                               \
+    bool Name##_pop(Name##_t* deque, V* out_value);                                           \
+    bool Name##_steal(Name##_t* deque, V* out_value);                                         \
+    size_t Name##_count(Name##_t* deque);                                                     \
+    phyto_deque_error_flag_t Name##_error_flag(Name##_t* deque);
+
+#define PHYTO_COLLECTIONS_CONCURRENT_DEQUE_IMPL(Name, Inner, V)                                \
+    bool Name##_init(Name##_t* deque, size_t capacity, const Inner##_callbacks_t* callbacks) { \
+        deque->deque = Inner##_new(capacity, callbacks);                                       \
+        if (deque->deque.error_flag != phyto_deque_error_flag_ok) {                            \
+            atomic_init(&deque->error_flag, deque->deque.error_flag);                          \
+            return false;                                                                      \
+        }                                                                                      \
+        if (pthread_mutex_init(&deque->mutex, NULL) != 0) {                                    \
+            Inner##_free(&deque->deque);                                                       \
+            deque->deque.data = NULL;                                                          \
+            atomic_init(&deque->error_flag, phyto_deque_error_flag_mutex);                     \
+            return false;                                                                      \
+        }                                                                                      \
+        atomic_init(&deque->error_flag, phyto_deque_error_flag_ok);                            \
+        return true;                                                                           \
+    }                                                                                          \
+    void Name##_free(Name##_t* deque) {                                                        \
+        if (deque->deque.data == NULL) {                                                       \
+            return;                                                                            \
+        }                                                                                      \
+        Inner##_free(&deque->deque);                                                           \
+        pthread_mutex_destroy(&deque->mutex);                                                  \
+    }                                                                                          \
+    bool Name##_push(Name##_t* deque, V value) {                                               \
+        if (pthread_mutex_lock(&deque->mutex) != 0) {                                          \
+            deque->error_flag = phyto_deque_error_flag_mutex;                                  \
+            return false;                                                                      \
+        }                                                                                      \
+        bool pushed = Inner##_push_back(&deque->deque, value);                                 \
+        deque->error_flag = deque->deque.error_flag;                                           \
+        pthread_mutex_unlock(&deque->mutex);                                                   \
+        return pushed;                                                                         \
+    }                                                                                          \
+    bool Name##_pop(Name##_t* deque, V* out_value) {                                           \
+        if (pthread_mutex_lock(&deque->mutex) != 0) {                                          \
+            deque->error_flag = phyto_deque_error_flag_mutex;                                  \
+            return false;                                                                      \
+        }                                                                                      \
+        bool popped = !Inner##_empty(&deque->deque);                                           \
+        if (popped) {                                                                          \
+            *out_value = Inner##_back(&deque->deque);                                          \
+            Inner##_pop_back(&deque->deque);                                                   \
+        }                                                                                      \
+        deque->error_flag = popped ? phyto_deque_error_flag_ok : phyto_deque_error_flag_empty; \
+        pthread_mutex_unlock(&deque->mutex);                                                   \
+        return popped;                                                                         \
+    }                                                                                          \
+    bool Name##_steal(Name##_t* deque, V* out_value) {                                         \
+        if (pthread_mutex_lock(&deque->mutex) != 0) {                                          \
+            deque->error_flag = phyto_deque_error_flag_mutex;                                  \
+            return false;                                                                      \
+        }                                                                                      \
+        bool stolen = !Inner##_empty(&deque->deque);                                           \
+        if (stolen) {                                                                          \
+            *out_value = Inner##_front(&deque->deque);                                         \
+            Inner##_pop_front(&deque->deque);                                                  \
+        }                                                                                      \
+        deque->error_flag = stolen ? phyto_deque_error_flag_ok : phyto_deque_error_flag_empty; \
+        pthread_mutex_unlock(&deque->mutex);                                                   \
+        return stolen;                                                                         \
+    }                                                                                          \
+    size_t Name##_count(Name##_t* deque) {                                                     \
+        if (pthread_mutex_lock(&deque->mutex) != 0) {                                          \
+            deque->error_flag = phyto_deque_error_flag_mutex;                                  \
+            return 0;                                                                          \
+        }                                                                                      \
+        size_t count = Inner##_count(&deque->deque);                                           \
+        pthread_mutex_unlock(&deque->mutex);                                                   \
+        return count;                                                                          \
+    }                                                                                          \
+    phyto_deque_error_flag_t Name##_error_flag(Name##_t* deque) {                              \
+        return atomic_load(&deque->error_flag);                                                \
+    }
+
+#endif  // PHYTO_DEQUE_CONCURRENT_H_
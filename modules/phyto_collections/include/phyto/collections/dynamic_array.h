@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "phyto/collections/alloc_stats.h"
 #include "phyto/collections/callbacks.h"
 
 #define PHYTO_COLLECTIONS_DYNAMIC_ARRAY_DECL(Name, DataType)                                       \
@@ -66,6 +67,7 @@
     Name##_span_t Name##_as_span(Name##_t self);
 
 #define PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL(Name, DataType)                                       \
+    PHYTO_ALLOC_STATS_DEFINE(Name##_alloc_stats, #Name)                                            \
     const char* Name##_explain_error(Name##_error_flag_t error_flag) {                             \
         switch (error_flag) {                                                                      \
             case Name##_error_flag_ok:                                                             \
@@ -122,6 +124,9 @@
                 self->callbacks->free_cb(&self->data[i]);                                          \
             }                                                                                      \
         }                                                                                          \
+        PHYTO_ALLOC_STATS_WASTE(Name##_alloc_stats,                                                \
+                                (self->capacity - self->size) * sizeof(DataType));                 \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, self->capacity * sizeof(DataType), 0);        \
         free(self->data);                                                                          \
         self->data = NULL;                                                                         \
         self->size = 0;                                                                            \
@@ -142,6 +147,8 @@
             self->error_flag = Name##_error_flag_out_of_memory;                                    \
             return false;                                                                          \
         }                                                                                          \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, old_capacity * sizeof(DataType),              \
+                                 self->capacity * sizeof(DataType));                               \
         memset(new_data + old_capacity, 0, (self->capacity - old_capacity) * sizeof(DataType));    \
         self->data = new_data;                                                                     \
         return true;                                                                               \
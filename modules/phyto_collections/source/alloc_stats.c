@@ -0,0 +1,86 @@
+#include "phyto/collections/alloc_stats.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+// containers allocate from any thread, so the list and counters are only touched atomically
+static phyto_alloc_stats_t* registry = NULL;
+
+static void enroll(phyto_alloc_stats_t* stats) {
+    if (__atomic_load_n(&stats->registered, __ATOMIC_ACQUIRE) ||
+        __atomic_exchange_n(&stats->registered, true, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+    stats->next = __atomic_load_n(&registry, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&registry, &stats->next, stats, true, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED)) {
+    }
+}
+
+void phyto_alloc_stats_record(phyto_alloc_stats_t* stats, size_t old_bytes, size_t new_bytes) {
+    if (old_bytes == 0 && new_bytes == 0) {
+        return;
+    }
+    enroll(stats);
+    if (new_bytes == 0) {
+        __atomic_add_fetch(&stats->frees, 1, __ATOMIC_RELAXED);
+    } else if (old_bytes == 0) {
+        __atomic_add_fetch(&stats->allocations, 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_add_fetch(&stats->reallocations, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_add_fetch(&stats->bytes_allocated, new_bytes, __ATOMIC_RELAXED);
+    // unsigned wraparound makes this a subtraction when the buffer shrank
+    uint64_t live = __atomic_add_fetch(&stats->live_bytes, (uint64_t)new_bytes - old_bytes,
+                                       __ATOMIC_RELAXED);
+    uint64_t peak = __atomic_load_n(&stats->peak_bytes, __ATOMIC_RELAXED);
+    while (live > peak && !__atomic_compare_exchange_n(&stats->peak_bytes, &peak, live, true,
+                                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void phyto_alloc_stats_waste(phyto_alloc_stats_t* stats, size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    enroll(stats);
+    __atomic_add_fetch(&stats->wasted_bytes, bytes, __ATOMIC_RELAXED);
+}
+
+const phyto_alloc_stats_t* phyto_alloc_stats_first(void) {
+    return __atomic_load_n(&registry, __ATOMIC_ACQUIRE);
+}
+
+static int compare_peaks(const void* a, const void* b) {
+    const phyto_alloc_stats_t* lhs = *(const phyto_alloc_stats_t* const*)a;
+    const phyto_alloc_stats_t* rhs = *(const phyto_alloc_stats_t* const*)b;
+    // largest first
+    return (lhs->peak_bytes < rhs->peak_bytes) - (lhs->peak_bytes > rhs->peak_bytes);
+}
+
+void phyto_alloc_stats_print(FILE* stream) {
+    size_t count = 0;
+    for (const phyto_alloc_stats_t* s = phyto_alloc_stats_first(); s != NULL; s = s->next) {
+        ++count;
+    }
+    const phyto_alloc_stats_t** rows = calloc(count + 1, sizeof(phyto_alloc_stats_t*));
+    if (rows == NULL) {
+        return;
+    }
+    size_t i = 0;
+    for (const phyto_alloc_stats_t* s = phyto_alloc_stats_first(); i < count; s = s->next) {
+        rows[i++] = s;
+    }
+    qsort(rows, count, sizeof(phyto_alloc_stats_t*), compare_peaks);
+    fprintf(stream, "%-20s %10s %10s %8s %14s %12s %12s %12s\n", "container", "allocs",
+            "reallocs", "frees", "allocated", "peak", "live", "wasted");
+    for (i = 0; i < count; ++i) {
+        const phyto_alloc_stats_t* s = rows[i];
+        fprintf(stream,
+                "%-20s %10" PRIu64 " %10" PRIu64 " %8" PRIu64 " %14" PRIu64 " %12" PRIu64
+                " %12" PRIu64 " %12" PRIu64 "\n",
+                s->name, s->allocations, s->reallocations, s->frees, s->bytes_allocated,
+                s->peak_bytes, s->live_bytes, s->wasted_bytes);
+    }
+    free(rows);
+}
@@ -1,9 +1,15 @@
+#define PHYTO_COLLECTIONS_CONCURRENT
+#include <inttypes.h>
 #include <phyto/collections/deque.h>
 #include <phyto/test/test.h>
+#include <pthread.h>
 #include <stdint.h>
+#include <string.h>
 
 PHYTO_COLLECTIONS_DEQUE_DECL(int_deque, int)
 PHYTO_COLLECTIONS_DEQUE_IMPL(int_deque, int)
+PHYTO_COLLECTIONS_CONCURRENT_DEQUE_DECL(int_work_deque, int_deque, int)
+PHYTO_COLLECTIONS_CONCURRENT_DEQUE_IMPL(int_work_deque, int_deque, int)
 
 static int32_t intcmp(int a, int b) {
     return (a > b) - (a < b);
@@ -41,8 +47,123 @@ static PHYTO_TEST_FUNC(push_pop) {
     PHYTO_TEST_PASS();
 }
 
+static PHYTO_TEST_FUNC(back_after_wrap) {
+    int_deque_t deque = int_deque_new(2, &int_deque_callbacks);
+    int_deque_push_back(&deque, 1);
+    int_deque_push_back(&deque, 2);
+    PHYTO_TEST_ASSERT(int_deque_back(&deque) == 2, int_deque_free(&deque), "back was wrong");
+    int_deque_free(&deque);
+    PHYTO_TEST_PASS();
+}
+
+static PHYTO_TEST_FUNC(owner_and_thief) {
+    int_work_deque_t deque;
+    PHYTO_TEST_ASSERT(int_work_deque_init(&deque, 1, &int_deque_callbacks), (void)0,
+                      "init failed");
+    for (int i = 1; i <= 3; ++i) {
+        int_work_deque_push(&deque, i);
+    }
+    int value = 0;
+    PHYTO_TEST_ASSERT(int_work_deque_pop(&deque, &value) && value == 3,
+                      int_work_deque_free(&deque), "owner should take the newest");
+    PHYTO_TEST_ASSERT(int_work_deque_steal(&deque, &value) && value == 1,
+                      int_work_deque_free(&deque), "thief should take the oldest");
+    PHYTO_TEST_ASSERT(int_work_deque_pop(&deque, &value) && value == 2,
+                      int_work_deque_free(&deque), "last item was wrong");
+    PHYTO_TEST_ASSERT(!int_work_deque_steal(&deque, &value), int_work_deque_free(&deque),
+                      "steal from empty deque succeeded");
+    PHYTO_TEST_ASSERT(int_work_deque_error_flag(&deque) == phyto_deque_error_flag_empty,
+                      int_work_deque_free(&deque), "error flag was wrong");
+    int_work_deque_free(&deque);
+    PHYTO_TEST_PASS();
+}
+
+#define STEAL_ITEMS 10000
+#define STEAL_THIEVES 4
+
+typedef struct {
+    int_work_deque_t* deque;
+    int64_t sum;
+} thief_t;
+
+static void* thief_main(void* arg) {
+    thief_t* thief = arg;
+    int value;
+    while (int_work_deque_steal(thief->deque, &value)) {
+        thief->sum += value;
+    }
+    return NULL;
+}
+
+static PHYTO_TEST_FUNC(concurrent_steal) {
+    int_work_deque_t deque;
+    PHYTO_TEST_ASSERT(int_work_deque_init(&deque, 16, &int_deque_callbacks), (void)0,
+                      "init failed");
+    for (int i = 1; i <= STEAL_ITEMS; ++i) {
+        int_work_deque_push(&deque, i);
+    }
+    thief_t thieves[STEAL_THIEVES];
+    pthread_t threads[STEAL_THIEVES];
+    for (size_t i = 0; i < STEAL_THIEVES; ++i) {
+        thieves[i] = (thief_t){.deque = &deque};
+        pthread_create(&threads[i], NULL, thief_main, &thieves[i]);
+    }
+    int64_t sum = 0;
+    int value;
+    while (int_work_deque_pop(&deque, &value)) {
+        sum += value;
+    }
+    for (size_t i = 0; i < STEAL_THIEVES; ++i) {
+        pthread_join(threads[i], NULL);
+        sum += thieves[i].sum;
+    }
+    int_work_deque_free(&deque);
+    PHYTO_TEST_ASSERT(sum == (int64_t)STEAL_ITEMS * (STEAL_ITEMS + 1) / 2, (void)0,
+                      "items were lost or taken twice");
+    PHYTO_TEST_PASS();
+}
+
+#ifdef PHYTO_ALLOC_STATS
+static const phyto_alloc_stats_t* find_alloc_stats(const char* name) {
+    for (const phyto_alloc_stats_t* s = phyto_alloc_stats_first(); s != NULL; s = s->next) {
+        if (strcmp(s->name, name) == 0) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+static PHYTO_TEST_FUNC(alloc_stats) {
+    int_deque_t deque = int_deque_new(1, &int_deque_callbacks);
+    const phyto_alloc_stats_t* stats = find_alloc_stats("int_deque");
+    PHYTO_TEST_ASSERT(stats != NULL, int_deque_free(&deque), "no int_deque record");
+    uint64_t bytes = stats->bytes_allocated;
+    uint64_t peak = stats->peak_bytes;
+    uint64_t reallocations = stats->reallocations;
+    // larger than any other deque in this file, so the peak has to move
+    for (int i = 0; i < 1 << 15; ++i) {
+        int_deque_push_back(&deque, i);
+    }
+    PHYTO_TEST_ASSERT(stats->bytes_allocated > bytes, int_deque_free(&deque),
+                      "bytes_allocated did not grow");
+    PHYTO_TEST_ASSERT(stats->peak_bytes > peak && stats->peak_bytes >= stats->live_bytes,
+                      int_deque_free(&deque), "peak_bytes == %" PRIu64 ", was %" PRIu64,
+                      stats->peak_bytes, peak);
+    PHYTO_TEST_ASSERT(stats->reallocations > reallocations, int_deque_free(&deque),
+                      "growing was not counted as a reallocation");
+    int_deque_free(&deque);
+    PHYTO_TEST_PASS();
+}
+#endif
+
 static PHYTO_TEST_SUITE_FUNC(deque) {
     PHYTO_TEST_RUN(push_pop);
+    PHYTO_TEST_RUN(back_after_wrap);
+    PHYTO_TEST_RUN(owner_and_thief);
+    PHYTO_TEST_RUN(concurrent_steal);
+#ifdef PHYTO_ALLOC_STATS
+    PHYTO_TEST_RUN(alloc_stats);
+#endif
 }
 
 int main(void) {
@@ -1,12 +1,16 @@
 #ifndef PHYTO_HASH_HASH_H_
 #define PHYTO_HASH_HASH_H_
 
+#include <phyto/collections/alloc_stats.h>
 #include <phyto/string/string.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define PHYTO_HASH_FLAGS_X                        \
     X(ok, "ok")                                   \
@@ -33,19 +37,75 @@ uint64_t phyto_hash_fnv1a(phyto_string_span_t s);
 uint64_t phyto_hash_djb2(phyto_string_span_t s);
 extern const double phyto_hash_default_load;
 
+// every slot has a control byte: empty, deleted, or 7 bits of the hash of the key it holds.
+// probes scan a group of control bytes at a time and only look at keys whose fragment matches.
+// the first group is mirrored past the last slot, so a group starting anywhere can be loaded
+// without wrapping. a removed slot only stays deleted while some probe may have run past it;
+// once deleted slots crowd the table, the next insert rebuilds it in place
+#define PHYTO_HASH_GROUP_WIDTH 16
+#define PHYTO_HASH_CTRL_EMPTY ((uint8_t)0x80)
+#define PHYTO_HASH_CTRL_DELETED ((uint8_t)0xFE)
+
+static inline bool phyto_hash_ctrl_is_full(uint8_t ctrl) {
+    return (ctrl & 0x80) == 0;
+}
+
+// short keys leave the top bits of weak hashes like djb2 all zero, so the fragment comes from
+// a remix. the constant differs from the pow2 policy's, and the fold brings in the low half,
+// so the fragment stays independent of the bits either policy picks the home slot from
+static inline uint8_t phyto_hash_fragment(uint64_t hash) {
+    return (uint8_t)(((hash ^ (hash >> 32)) * UINT64_C(0xFF51AFD7ED558CCD)) >> 57);
+}
+
+// bit i is set when group[i] == ctrl
+static inline uint32_t phyto_hash_group_match(const uint8_t* group, uint8_t ctrl) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)ctrl)));
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < PHYTO_HASH_GROUP_WIDTH; ++i) {
+        mask |= (uint32_t)(group[i] == ctrl) << i;
+    }
+    return mask;
+#endif
+}
+
+// bit i is set when group[i] is empty or deleted
+static inline uint32_t phyto_hash_group_match_free(const uint8_t* group) {
+#ifdef __SSE2__
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < PHYTO_HASH_GROUP_WIDTH; ++i) {
+        mask |= (uint32_t)!phyto_hash_ctrl_is_full(group[i]) << i;
+    }
+    return mask;
+#endif
+}
+
+// how a map turns a hash into the slot its probe starts at. prime tables take the hash modulo
+// a prime from phyto_hash_prime_span. pow2 tables multiply by 2^64 / phi and keep the top bits,
+// which spreads weak hashes over the whole table without a division
+typedef enum {
+    phyto_hash_policy_prime,
+    phyto_hash_policy_pow2,
+} phyto_hash_policy_t;
+
+// pow2 tables keep this many of the mixed hash's top bits
+static inline unsigned phyto_hash_pow2_shift(size_t capacity) {
+    return (unsigned)__builtin_clzll((unsigned long long)capacity) + 1;
+}
+
 #define PHYTO_HASH_DECL(Name, V)                                                               \
-    typedef enum {                                                                             \
-        Name##_entry_state_empty,                                                              \
-        Name##_entry_state_filled,                                                             \
-        Name##_entry_state_deleted,                                                            \
-    } Name##_entry_state_t;                                                                    \
     typedef struct {                                                                           \
         phyto_string_t key;                                                                    \
         V value;                                                                               \
-        Name##_entry_state_t state;                                                            \
+        uint64_t hash;                                                                         \
     } Name##_entry_t;                                                                          \
     typedef struct {                                                                           \
         uint64_t (*hash)(phyto_string_span_t);                                                 \
+        phyto_hash_policy_t policy;                                                            \
     } Name##_key_ops_t;                                                                        \
     typedef struct {                                                                           \
         int32_t (*compare)(V, V);                                                              \
@@ -56,8 +116,11 @@ extern const double phyto_hash_default_load;
     } Name##_value_ops_t;                                                                      \
     typedef struct {                                                                           \
         Name##_entry_t* buffer;                                                                \
+        uint8_t* ctrl;                                                                         \
         size_t capacity;                                                                       \
+        unsigned shift;                                                                        \
         size_t count;                                                                          \
+        size_t tombstones;                                                                     \
         double load;                                                                           \
         phyto_hash_flag_t flag;                                                                \
         const Name##_key_ops_t* key_ops;                                                       \
@@ -86,8 +149,27 @@ extern const double phyto_hash_default_load;
     bool Name##_equals(Name##_t* map, Name##_t* other)
 
 #define PHYTO_HASH_IMPL(Name, V)                                                                \
+    PHYTO_ALLOC_STATS_DEFINE(Name##_alloc_stats, #Name)                                         \
     static Name##_entry_t* Name##_impl_get_entry(Name##_t* map, phyto_string_span_t key);       \
-    static size_t Name##_impl_calculate_size(size_t required);                                  \
+    static Name##_entry_t* Name##_impl_get_entry_hashed(Name##_t* map, phyto_string_span_t key, \
+                                                        uint64_t hash);                         \
+    static size_t Name##_impl_calculate_size(phyto_hash_policy_t policy, size_t required);      \
+    static size_t Name##_impl_home(Name##_t* map, uint64_t hash) {                              \
+        if (map->key_ops->policy == phyto_hash_policy_pow2) {                                   \
+            return (size_t)((hash * UINT64_C(0x9E3779B97F4A7C15)) >> map->shift);               \
+        }                                                                                       \
+        return hash % map->capacity;                                                            \
+    }                                                                                           \
+    static size_t Name##_impl_find_free(Name##_t* map, uint64_t hash);                          \
+    static bool Name##_impl_rehash(Name##_t* map, size_t capacity);                             \
+    static bool Name##_impl_make_room(Name##_t* map);                                           \
+    static void Name##_impl_erase_ctrl(Name##_t* map, size_t slot);                             \
+    static void Name##_impl_set_ctrl(Name##_t* map, size_t slot, uint8_t ctrl) {                \
+        map->ctrl[slot] = ctrl;                                                                 \
+        if (slot < PHYTO_HASH_GROUP_WIDTH) {                                                    \
+            map->ctrl[map->capacity + slot] = ctrl;                                             \
+        }                                                                                       \
+    }                                                                                           \
     Name##_t* Name##_new(size_t capacity, double load, const Name##_key_ops_t* key_ops,         \
                          const Name##_value_ops_t* value_ops) {                                 \
         if (capacity == 0 || load <= 0 || load >= 1) {                                          \
@@ -99,18 +181,30 @@ extern const double phyto_hash_default_load;
         if (!value_ops) {                                                                       \
             return NULL;                                                                        \
         }                                                                                       \
-        size_t real_capacity = Name##_impl_calculate_size((size_t)((double)capacity / load));   \
+        size_t real_capacity =                                                                  \
+            Name##_impl_calculate_size(key_ops->policy, (size_t)((double)capacity / load));     \
         Name##_t* map = malloc(sizeof(Name##_t));                                               \
         if (!map) {                                                                             \
             return NULL;                                                                        \
         }                                                                                       \
         map->buffer = calloc(real_capacity, sizeof(Name##_entry_t));                            \
-        if (!map->buffer) {                                                                     \
+        map->ctrl = malloc(real_capacity + PHYTO_HASH_GROUP_WIDTH);                             \
+        if (!map->buffer || !map->ctrl) {                                                       \
+            free(map->buffer);                                                                  \
+            free(map->ctrl);                                                                    \
             free(map);                                                                          \
             return NULL;                                                                        \
         }                                                                                       \
+        memset(map->ctrl, PHYTO_HASH_CTRL_EMPTY, real_capacity + PHYTO_HASH_GROUP_WIDTH);       \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, 0, sizeof(Name##_t));                      \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, 0,                                         \
+                                 real_capacity * sizeof(Name##_entry_t));                       \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, 0,                                         \
+                                 real_capacity + PHYTO_HASH_GROUP_WIDTH);                       \
         map->count = 0;                                                                         \
+        map->tombstones = 0;                                                                    \
         map->capacity = real_capacity;                                                          \
+        map->shift = phyto_hash_pow2_shift(real_capacity);                                      \
         map->load = load;                                                                       \
         map->flag = phyto_hash_flag_ok;                                                         \
         map->key_ops = key_ops;                                                                 \
@@ -120,7 +214,7 @@ extern const double phyto_hash_default_load;
     void Name##_clear(Name##_t* map) {                                                          \
         for (size_t i = 0; i < map->capacity; ++i) {                                            \
             Name##_entry_t* entry = &map->buffer[i];                                            \
-            if (entry->state == Name##_entry_state_filled) {                                    \
+            if (phyto_hash_ctrl_is_full(map->ctrl[i])) {                                        \
                 phyto_string_free(&entry->key);                                                 \
                 if (map->value_ops->free) {                                                     \
                     map->value_ops->free(entry->value);                                         \
@@ -128,55 +222,47 @@ extern const double phyto_hash_default_load;
             }                                                                                   \
         }                                                                                       \
         memset(map->buffer, 0, sizeof(Name##_entry_t) * map->capacity);                         \
+        memset(map->ctrl, PHYTO_HASH_CTRL_EMPTY, map->capacity + PHYTO_HASH_GROUP_WIDTH);       \
         map->count = 0;                                                                         \
+        map->tombstones = 0;                                                                    \
         map->flag = phyto_hash_flag_ok;                                                         \
     }                                                                                           \
     void Name##_free(Name##_t* map) {                                                           \
         for (size_t i = 0; i < map->capacity; ++i) {                                            \
             Name##_entry_t* entry = &map->buffer[i];                                            \
-            if (entry->state == Name##_entry_state_filled) {                                    \
+            if (phyto_hash_ctrl_is_full(map->ctrl[i])) {                                        \
                 phyto_string_free(&entry->key);                                                 \
                 if (map->value_ops->free) {                                                     \
                     map->value_ops->free(entry->value);                                         \
                 }                                                                               \
             }                                                                                   \
         }                                                                                       \
+        PHYTO_ALLOC_STATS_WASTE(Name##_alloc_stats,                                             \
+                                (map->capacity - map->count) * sizeof(Name##_entry_t));         \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats,                                            \
+                                 map->capacity * sizeof(Name##_entry_t), 0);                    \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats,                                            \
+                                 map->capacity + PHYTO_HASH_GROUP_WIDTH, 0);                    \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, sizeof(Name##_t), 0);                      \
         free(map->buffer);                                                                      \
+        free(map->ctrl);                                                                        \
         free(map);                                                                              \
     }                                                                                           \
     bool Name##_insert(Name##_t* map, phyto_string_span_t key, V value) {                       \
-        if (Name##_full(map)) {                                                                 \
-            if (!Name##_resize(map, map->capacity + 1)) {                                       \
-                return false;                                                                   \
-            }                                                                                   \
-        }                                                                                       \
-        if (Name##_impl_get_entry(map, key) != NULL) {                                          \
+        uint64_t hash = map->key_ops->hash(key);                                                \
+        if (Name##_impl_get_entry_hashed(map, key, hash) != NULL) {                             \
             map->flag = phyto_hash_flag_duplicate;                                              \
             return false;                                                                       \
         }                                                                                       \
-        size_t hash = map->key_ops->hash(key);                                                  \
-        size_t original_pos = hash % map->capacity;                                             \
-        size_t pos = original_pos;                                                              \
-                                                                                                \
-        Name##_entry_t* target = &map->buffer[pos];                                             \
-        if (target->state == Name##_entry_state_empty ||                                        \
-            target->state == Name##_entry_state_deleted) {                                      \
-            target->key = phyto_string_own(key);                                                \
-            target->value = value;                                                              \
-            target->state = Name##_entry_state_filled;                                          \
-        } else {                                                                                \
-            while (true) {                                                                      \
-                pos++;                                                                          \
-                target = &map->buffer[pos % map->capacity];                                     \
-                if (target->state == Name##_entry_state_empty ||                                \
-                    target->state == Name##_entry_state_deleted) {                              \
-                    target->key = phyto_string_own(key);                                        \
-                    target->value = value;                                                      \
-                    target->state = Name##_entry_state_filled;                                  \
-                    break;                                                                      \
-                }                                                                               \
-            }                                                                                   \
+        if (!Name##_impl_make_room(map)) {                                                      \
+            return false;                                                                       \
         }                                                                                       \
+        size_t slot = Name##_impl_find_free(map, hash);                                         \
+        map->tombstones -= map->ctrl[slot] == PHYTO_HASH_CTRL_DELETED;                          \
+        map->buffer[slot].key = phyto_string_own(key);                                          \
+        map->buffer[slot].value = value;                                                        \
+        map->buffer[slot].hash = hash;                                                          \
+        Name##_impl_set_ctrl(map, slot, phyto_hash_fragment(hash));                             \
         map->count++;                                                                           \
         map->flag = phyto_hash_flag_ok;                                                         \
         return true;                                                                            \
@@ -213,7 +299,7 @@ extern const double phyto_hash_default_load;
         }                                                                                       \
         phyto_string_free(&entry->key);                                                         \
         entry->value = (V){0};                                                                  \
-        entry->state = Name##_entry_state_deleted;                                              \
+        Name##_impl_erase_ctrl(map, (size_t)(entry - map->buffer));                             \
         map->count--;                                                                           \
         map->flag = phyto_hash_flag_ok;                                                         \
         return true;                                                                            \
@@ -228,7 +314,7 @@ extern const double phyto_hash_default_load;
         V max_value = (V){0};                                                                   \
         for (size_t i = 0; i < map->capacity; ++i) {                                            \
             Name##_entry_t* entry = &map->buffer[i];                                            \
-            if (entry->state == Name##_entry_state_filled) {                                    \
+            if (phyto_hash_ctrl_is_full(map->ctrl[i])) {                                        \
                 if (first) {                                                                    \
                     first = false;                                                              \
                     max_key = entry->key;                                                       \
@@ -259,7 +345,7 @@ extern const double phyto_hash_default_load;
         V min_value = (V){0};                                                                   \
         for (size_t i = 0; i < map->capacity; ++i) {                                            \
             Name##_entry_t* entry = &map->buffer[i];                                            \
-            if (entry->state == Name##_entry_state_filled) {                                    \
+            if (phyto_hash_ctrl_is_full(map->ctrl[i])) {                                        \
                 if (first) {                                                                    \
                     first = false;                                                              \
                     min_key = entry->key;                                                       \
@@ -330,40 +416,17 @@ extern const double phyto_hash_default_load;
             map->flag = phyto_hash_flag_error;                                                  \
             return false;                                                                       \
         }                                                                                       \
-        size_t theoretical_size = Name##_impl_calculate_size(capacity);                         \
+        size_t theoretical_size = Name##_impl_calculate_size(map->key_ops->policy, capacity);   \
         if ((double)theoretical_size < (double)map->count / map->load) {                        \
             map->flag = phyto_hash_flag_overflow;                                               \
             return false;                                                                       \
         }                                                                                       \
-        Name##_t* new_map = Name##_new(capacity, map->load, map->key_ops, map->value_ops);      \
-        if (!new_map) {                                                                         \
+        size_t real_capacity = Name##_impl_calculate_size(                                      \
+            map->key_ops->policy, (size_t)((double)capacity / map->load));                      \
+        if (!Name##_impl_rehash(map, real_capacity)) {                                          \
             map->flag = phyto_hash_flag_alloc;                                                  \
             return false;                                                                       \
         }                                                                                       \
-        for (size_t i = 0; i < map->capacity; ++i) {                                            \
-            if (map->buffer[i].state == Name##_entry_state_filled) {                            \
-                phyto_string_span_t key = phyto_string_as_span(map->buffer[i].key);             \
-                V value = map->buffer[i].value;                                                 \
-                if (!Name##_insert(new_map, key, value)) {                                      \
-                    map->flag = new_map->flag;                                                  \
-                    Name##_free(new_map);                                                       \
-                    return false;                                                               \
-                }                                                                               \
-            }                                                                                   \
-        }                                                                                       \
-        if (map->count != new_map->count) {                                                     \
-            map->flag = phyto_hash_flag_error;                                                  \
-            Name##_free(new_map);                                                               \
-            return false;                                                                       \
-        }                                                                                       \
-        Name##_entry_t* tmp_b = map->buffer;                                                    \
-        map->buffer = new_map->buffer;                                                          \
-        new_map->buffer = tmp_b;                                                                \
-        size_t tmp_c = map->capacity;                                                           \
-        map->capacity = new_map->capacity;                                                      \
-        new_map->capacity = tmp_c;                                                              \
-        new_map->value_ops = &((Name##_value_ops_t){0});                                        \
-        Name##_free(new_map);                                                                   \
         return true;                                                                            \
     }                                                                                           \
     Name##_t* Name##_copy_of(Name##_t* map) {                                                   \
@@ -373,19 +436,17 @@ extern const double phyto_hash_default_load;
             return NULL;                                                                        \
         }                                                                                       \
         for (size_t i = 0; i < map->capacity; ++i) {                                            \
-            Name##_entry_t* scan = &map->buffer[i];                                             \
-            if (scan->state != Name##_entry_state_empty) {                                      \
-                Name##_entry_t* target = &result->buffer[i];                                    \
-                if (scan->state == Name##_entry_state_deleted) {                                \
-                    target->state = Name##_entry_state_deleted;                                 \
+            if (phyto_hash_ctrl_is_full(map->ctrl[i])) {                                        \
+                Name##_entry_t* scan = &map->buffer[i];                                         \
+                size_t slot = Name##_impl_find_free(result, scan->hash);                        \
+                Name##_entry_t* target = &result->buffer[slot];                                 \
+                target->key = phyto_string_copy(scan->key);                                     \
+                target->hash = scan->hash;                                                      \
+                Name##_impl_set_ctrl(result, slot, phyto_hash_fragment(scan->hash));            \
+                if (map->value_ops->copy) {                                                     \
+                    target->value = map->value_ops->copy(scan->value);                          \
                 } else {                                                                        \
-                    target->state = Name##_entry_state_filled;                                  \
-                    target->key = phyto_string_copy(scan->key);                                 \
-                    if (map->value_ops->copy) {                                                 \
-                        target->value = map->value_ops->copy(scan->value);                      \
-                    } else {                                                                    \
-                        target->value = scan->value;                                            \
-                    }                                                                           \
+                    target->value = scan->value;                                                \
                 }                                                                               \
             }                                                                                   \
         }                                                                                       \
@@ -401,11 +462,14 @@ extern const double phyto_hash_default_load;
         }                                                                                       \
         Name##_t* map_a = map1->capacity < map2->capacity ? map1 : map2;                        \
         Name##_t* map_b = map_a == map1 ? map2 : map1;                                          \
+        bool same_hash = map_a->key_ops->hash == map_b->key_ops->hash;                          \
         for (size_t i = 0; i < map_a->capacity; ++i) {                                          \
-            if (map_a->buffer[i].state == Name##_entry_state_filled) {                          \
+            if (phyto_hash_ctrl_is_full(map_a->ctrl[i])) {                                      \
                 Name##_entry_t* entry_a = &map_a->buffer[i];                                    \
+                phyto_string_span_t key = phyto_string_as_span(entry_a->key);                   \
                 Name##_entry_t* entry_b =                                                       \
-                    Name##_impl_get_entry(map_b, phyto_string_as_span(entry_a->key));           \
+                    same_hash ? Name##_impl_get_entry_hashed(map_b, key, entry_a->hash)         \
+                              : Name##_impl_get_entry(map_b, key);                              \
                 if (!entry_b) {                                                                 \
                     return false;                                                               \
                 }                                                                               \
@@ -417,20 +481,110 @@ extern const double phyto_hash_default_load;
         return true;                                                                            \
     }                                                                                           \
     static Name##_entry_t* Name##_impl_get_entry(Name##_t* map, phyto_string_span_t key) {      \
-        size_t hash = map->key_ops->hash(key);                                                  \
-        size_t pos = hash % map->capacity;                                                      \
-        Name##_entry_t* target = &map->buffer[pos];                                             \
-        while (target->state == Name##_entry_state_filled ||                                    \
-               target->state == Name##_entry_state_deleted) {                                   \
-            if (phyto_string_span_equal(key, phyto_string_as_span(target->key))) {              \
-                return target;                                                                  \
+        return Name##_impl_get_entry_hashed(map, key, map->key_ops->hash(key));                 \
+    }                                                                                           \
+    static Name##_entry_t* Name##_impl_get_entry_hashed(Name##_t* map, phyto_string_span_t key, \
+                                                        uint64_t hash) {                        \
+        uint8_t fragment = phyto_hash_fragment(hash);                                           \
+        size_t pos = Name##_impl_home(map, hash);                                               \
+        for (size_t probed = 0; probed < map->capacity; probed += PHYTO_HASH_GROUP_WIDTH) {     \
+            const uint8_t* group = &map->ctrl[pos];                                             \
+            for (uint32_t m = phyto_hash_group_match(group, fragment); m != 0; m &= m - 1) {    \
+                size_t slot = pos + (size_t)__builtin_ctz(m);                                   \
+                slot = slot < map->capacity ? slot : slot - map->capacity;                      \
+                Name##_entry_t* target = &map->buffer[slot];                                    \
+                if (target->hash == hash &&                                                     \
+                    phyto_string_span_equal(key, phyto_string_as_span(target->key))) {          \
+                    return target;                                                              \
+                }                                                                               \
+            }                                                                                   \
+            if (phyto_hash_group_match(group, PHYTO_HASH_CTRL_EMPTY) != 0) {                    \
+                return NULL;                                                                    \
             }                                                                                   \
-            pos++;                                                                              \
-            target = &map->buffer[pos % map->capacity];                                         \
+            pos += PHYTO_HASH_GROUP_WIDTH;                                                      \
+            pos = pos < map->capacity ? pos : pos - map->capacity;                              \
         }                                                                                       \
         return NULL;                                                                            \
     }                                                                                           \
-    static size_t Name##_impl_calculate_size(size_t required) {                                 \
+    static size_t Name##_impl_find_free(Name##_t* map, uint64_t hash) {                         \
+        size_t pos = Name##_impl_home(map, hash);                                               \
+        while (true) {                                                                          \
+            uint32_t m = phyto_hash_group_match_free(&map->ctrl[pos]);                          \
+            if (m != 0) {                                                                       \
+                size_t slot = pos + (size_t)__builtin_ctz(m);                                   \
+                return slot < map->capacity ? slot : slot - map->capacity;                      \
+            }                                                                                   \
+            pos += PHYTO_HASH_GROUP_WIDTH;                                                      \
+            pos = pos < map->capacity ? pos : pos - map->capacity;                              \
+        }                                                                                       \
+    }                                                                                           \
+    static bool Name##_impl_rehash(Name##_t* map, size_t capacity) {                            \
+        Name##_entry_t* buffer = calloc(capacity, sizeof(Name##_entry_t));                      \
+        uint8_t* ctrl = malloc(capacity + PHYTO_HASH_GROUP_WIDTH);                              \
+        if (!buffer || !ctrl) {                                                                 \
+            free(buffer);                                                                       \
+            free(ctrl);                                                                         \
+            return false;                                                                       \
+        }                                                                                       \
+        memset(ctrl, PHYTO_HASH_CTRL_EMPTY, capacity + PHYTO_HASH_GROUP_WIDTH);                 \
+        Name##_entry_t* old_buffer = map->buffer;                                               \
+        uint8_t* old_ctrl = map->ctrl;                                                          \
+        size_t old_capacity = map->capacity;                                                    \
+        map->buffer = buffer;                                                                   \
+        map->ctrl = ctrl;                                                                       \
+        map->capacity = capacity;                                                               \
+        map->shift = phyto_hash_pow2_shift(capacity);                                           \
+        map->tombstones = 0;                                                                    \
+        for (size_t i = 0; i < old_capacity; ++i) {                                             \
+            if (phyto_hash_ctrl_is_full(old_ctrl[i])) {                                         \
+                size_t slot = Name##_impl_find_free(map, old_buffer[i].hash);                   \
+                map->buffer[slot] = old_buffer[i];                                              \
+                Name##_impl_set_ctrl(map, slot, phyto_hash_fragment(old_buffer[i].hash));       \
+            }                                                                                   \
+        }                                                                                       \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, old_capacity * sizeof(Name##_entry_t),     \
+                                 capacity * sizeof(Name##_entry_t));                            \
+        PHYTO_ALLOC_STATS_RECORD(Name##_alloc_stats, old_capacity + PHYTO_HASH_GROUP_WIDTH,     \
+                                 capacity + PHYTO_HASH_GROUP_WIDTH);                            \
+        free(old_buffer);                                                                       \
+        free(old_ctrl);                                                                         \
+        return true;                                                                            \
+    }                                                                                           \
+    static bool Name##_impl_make_room(Name##_t* map) {                                          \
+        size_t used = map->count + map->tombstones;                                             \
+        if ((double)map->capacity * map->load > (double)used) {                                 \
+            return true;                                                                        \
+        }                                                                                       \
+        if (!Name##_full(map) && map->tombstones * 4 >= used) {                                 \
+            if (!Name##_impl_rehash(map, map->capacity)) {                                      \
+                map->flag = phyto_hash_flag_alloc;                                              \
+                return false;                                                                   \
+            }                                                                                   \
+            return true;                                                                        \
+        }                                                                                       \
+        return Name##_resize(map, map->capacity + 1);                                           \
+    }                                                                                           \
+    static void Name##_impl_erase_ctrl(Name##_t* map, size_t slot) {                            \
+        size_t before = (slot + map->capacity - PHYTO_HASH_GROUP_WIDTH) % map->capacity;        \
+        uint32_t behind = phyto_hash_group_match(&map->ctrl[before], PHYTO_HASH_CTRL_EMPTY);    \
+        uint32_t ahead = phyto_hash_group_match(&map->ctrl[slot], PHYTO_HASH_CTRL_EMPTY);       \
+        if (behind != 0 && ahead != 0 &&                                                        \
+            (size_t)__builtin_ctz(ahead) + (size_t)(__builtin_clz(behind) - 16) <               \
+                PHYTO_HASH_GROUP_WIDTH) {                                                       \
+            Name##_impl_set_ctrl(map, slot, PHYTO_HASH_CTRL_EMPTY);                             \
+            return;                                                                             \
+        }                                                                                       \
+        Name##_impl_set_ctrl(map, slot, PHYTO_HASH_CTRL_DELETED);                               \
+        map->tombstones++;                                                                      \
+    }                                                                                           \
+    static size_t Name##_impl_calculate_size(phyto_hash_policy_t policy, size_t required) {     \
+        if (policy == phyto_hash_policy_pow2) {                                                 \
+            size_t capacity = PHYTO_HASH_GROUP_WIDTH;                                           \
+            while (capacity < required && capacity <= SIZE_MAX / 2) {                           \
+                capacity <<= 1;                                                                 \
+            }                                                                                   \
+            return capacity;                                                                    \
+        }                                                                                       \
         const phyto_hash_prime_span_t prime_span = phyto_hash_prime_span();                     \
         const size_t count = prime_span.size;                                                   \
         if (prime_span.begin[count - 1] < required) {                                           \
@@ -469,190 +623,186 @@ extern const double phyto_hash_default_load;
     V* Name##_iter_value_ref(Name##_iter_t* iter);               \
     size_t Name##_iter_index(Name##_iter_t* iter)
 
-#define PHYTO_HASH_IMPL_ITER(Name, V)                                           \
-    Name##_iter_t Name##_iter_start(Name##_t* target) {                         \
-        Name##_iter_t iter = {                                                  \
-            .target = target,                                                   \
-            .cursor = 0,                                                        \
-            .index = 0,                                                         \
-            .first = 0,                                                         \
-            .last = 0,                                                          \
-            .at_start = true,                                                   \
-            .at_end = Name##_empty(target),                                     \
-        };                                                                      \
-        if (!Name##_empty(target)) {                                            \
-            for (size_t i = 0; i < target->capacity; ++i) {                     \
-                if (target->buffer[i].state == Name##_entry_state_filled) {     \
-                    iter.first = i;                                             \
-                    break;                                                      \
-                }                                                               \
-            }                                                                   \
-            iter.cursor = iter.first;                                           \
-            for (size_t i = target->capacity; i > 0; --i) {                     \
-                if (target->buffer[i - 1].state == Name##_entry_state_filled) { \
-                    iter.last = i - 1;                                          \
-                    break;                                                      \
-                }                                                               \
-            }                                                                   \
-        }                                                                       \
-        return iter;                                                            \
-    }                                                                           \
-    Name##_iter_t Name##_iter_end(Name##_t* target) {                           \
-        Name##_iter_t iter = {                                                  \
-            .target = target,                                                   \
-            .cursor = 0,                                                        \
-            .index = 0,                                                         \
-            .first = 0,                                                         \
-            .last = 0,                                                          \
-            .at_start = Name##_empty(target),                                   \
-            .at_end = true,                                                     \
-        };                                                                      \
-        if (!Name##_empty(target)) {                                            \
-            for (size_t i = 0; i < target->capacity; ++i) {                     \
-                if (target->buffer[i].state == Name##_entry_state_filled) {     \
-                    iter.first = i;                                             \
-                    break;                                                      \
-                }                                                               \
-            }                                                                   \
-            for (size_t i = target->capacity; i > 0; --i) {                     \
-                if (target->buffer[i - 1].state == Name##_entry_state_filled) { \
-                    iter.last = i - 1;                                          \
-                    break;                                                      \
-                }                                                               \
-            }                                                                   \
-            iter.cursor = iter.last;                                            \
-            iter.index = target->count - 1;                                     \
-        }                                                                       \
-        return iter;                                                            \
-    }                                                                           \
-    bool Name##_iter_at_start(Name##_iter_t* iter) {                            \
-        return Name##_empty(iter->target) || iter->at_start;                    \
-    }                                                                           \
-    bool Name##_iter_at_end(Name##_iter_t* iter) {                              \
-        return Name##_empty(iter->target) || iter->at_end;                      \
-    }                                                                           \
-    bool Name##_iter_to_start(Name##_iter_t* iter) {                            \
-        if (!Name##_empty(iter->target)) {                                      \
-            iter->cursor = iter->first;                                         \
-            iter->index = 0;                                                    \
-            iter->at_start = true;                                              \
-            iter->at_end = false;                                               \
-            return true;                                                        \
-        }                                                                       \
-        return false;                                                           \
-    }                                                                           \
-    bool Name##_iter_to_end(Name##_iter_t* iter) {                              \
-        if (!Name##_empty(iter->target)) {                                      \
-            iter->cursor = iter->last;                                          \
-            iter->index = iter->target->count - 1;                              \
-            iter->at_start = false;                                             \
-            iter->at_end = true;                                                \
-            return true;                                                        \
-        }                                                                       \
-        return false;                                                           \
-    }                                                                           \
-    bool Name##_iter_next(Name##_iter_t* iter) {                                \
-        if (iter->at_end) {                                                     \
-            return false;                                                       \
-        }                                                                       \
-        if (iter->index + 1 == iter->target->count) {                           \
-            iter->at_end = true;                                                \
-            return false;                                                       \
-        }                                                                       \
-        iter->at_start = Name##_empty(iter->target);                            \
-        Name##_entry_t* scan = &iter->target->buffer[iter->cursor];             \
-        iter->index++;                                                          \
-        while (true) {                                                          \
-            iter->cursor++;                                                     \
-            scan = &iter->target->buffer[iter->cursor];                         \
-            if (scan->state == Name##_entry_state_filled) {                     \
-                break;                                                          \
-            }                                                                   \
-        }                                                                       \
-        return true;                                                            \
-    }                                                                           \
-    bool Name##_iter_prev(Name##_iter_t* iter) {                                \
-        if (iter->at_start) {                                                   \
-            return false;                                                       \
-        }                                                                       \
-        if (iter->index == 0) {                                                 \
-            iter->at_start = true;                                              \
-            return false;                                                       \
-        }                                                                       \
-        iter->at_end = Name##_empty(iter->target);                              \
-        Name##_entry_t* scan = &iter->target->buffer[iter->cursor];             \
-        iter->index--;                                                          \
-        while (true) {                                                          \
-            iter->cursor--;                                                     \
-            scan = &iter->target->buffer[iter->cursor];                         \
-            if (scan->state == Name##_entry_state_filled) {                     \
-                break;                                                          \
-            }                                                                   \
-        }                                                                       \
-        return true;                                                            \
-    }                                                                           \
-    bool Name##_iter_advance(Name##_iter_t* iter, size_t steps) {               \
-        if (iter->at_end) {                                                     \
-            return false;                                                       \
-        }                                                                       \
-        if (iter->index + 1 == iter->target->count) {                           \
-            iter->at_end = true;                                                \
-            return false;                                                       \
-        }                                                                       \
-        if (steps == 0 || iter->index + steps >= iter->target->count) {         \
-            return false;                                                       \
-        }                                                                       \
-        for (size_t i = 0; i < steps; ++i) {                                    \
-            Name##_iter_next(iter);                                             \
-        }                                                                       \
-        return true;                                                            \
-    }                                                                           \
-    bool Name##_iter_rewind(Name##_iter_t* iter, size_t steps) {                \
-        if (iter->at_start) {                                                   \
-            return false;                                                       \
-        }                                                                       \
-        if (iter->index == 0) {                                                 \
-            iter->at_start = true;                                              \
-            return false;                                                       \
-        }                                                                       \
-        if (steps == 0 || iter->index < steps) {                                \
-            return false;                                                       \
-        }                                                                       \
-        for (size_t i = 0; i < steps; ++i) {                                    \
-            Name##_iter_prev(iter);                                             \
-        }                                                                       \
-        return true;                                                            \
-    }                                                                           \
-    bool Name##_iter_go_to(Name##_iter_t* iter, size_t index) {                 \
-        if (index >= iter->target->count) {                                     \
-            return false;                                                       \
-        }                                                                       \
-        if (iter->index > index) {                                              \
-            return Name##_iter_rewind(iter, iter->index - index);               \
-        }                                                                       \
-        if (iter->index < index) {                                              \
-            return Name##_iter_advance(iter, index - iter->index);              \
-        }                                                                       \
-        return true;                                                            \
-    }                                                                           \
-    phyto_string_span_t Name##_iter_key(Name##_iter_t* iter) {                  \
-        if (Name##_empty(iter->target)) {                                       \
-            return phyto_string_span_empty();                                   \
-        }                                                                       \
-        return phyto_string_as_span(iter->target->buffer[iter->cursor].key);    \
-    }                                                                           \
-    V Name##_iter_value(Name##_iter_t* iter) {                                  \
-        if (Name##_empty(iter->target)) {                                       \
-            return (V){0};                                                      \
-        }                                                                       \
-        return iter->target->buffer[iter->cursor].value;                        \
-    }                                                                           \
-    V* Name##_iter_value_ref(Name##_iter_t* iter) {                             \
-        if (Name##_empty(iter->target)) {                                       \
-            return NULL;                                                        \
-        }                                                                       \
-        return &iter->target->buffer[iter->cursor].value;                       \
-    }                                                                           \
+#define PHYTO_HASH_IMPL_ITER(Name, V)                                        \
+    Name##_iter_t Name##_iter_start(Name##_t* target) {                      \
+        Name##_iter_t iter = {                                               \
+            .target = target,                                                \
+            .cursor = 0,                                                     \
+            .index = 0,                                                      \
+            .first = 0,                                                      \
+            .last = 0,                                                       \
+            .at_start = true,                                                \
+            .at_end = Name##_empty(target),                                  \
+        };                                                                   \
+        if (!Name##_empty(target)) {                                         \
+            for (size_t i = 0; i < target->capacity; ++i) {                  \
+                if (phyto_hash_ctrl_is_full(target->ctrl[i])) {              \
+                    iter.first = i;                                          \
+                    break;                                                   \
+                }                                                            \
+            }                                                                \
+            iter.cursor = iter.first;                                        \
+            for (size_t i = target->capacity; i > 0; --i) {                  \
+                if (phyto_hash_ctrl_is_full(target->ctrl[i - 1])) {          \
+                    iter.last = i - 1;                                       \
+                    break;                                                   \
+                }                                                            \
+            }                                                                \
+        }                                                                    \
+        return iter;                                                         \
+    }                                                                        \
+    Name##_iter_t Name##_iter_end(Name##_t* target) {                        \
+        Name##_iter_t iter = {                                               \
+            .target = target,                                                \
+            .cursor = 0,                                                     \
+            .index = 0,                                                      \
+            .first = 0,                                                      \
+            .last = 0,                                                       \
+            .at_start = Name##_empty(target),                                \
+            .at_end = true,                                                  \
+        };                                                                   \
+        if (!Name##_empty(target)) {                                         \
+            for (size_t i = 0; i < target->capacity; ++i) {                  \
+                if (phyto_hash_ctrl_is_full(target->ctrl[i])) {              \
+                    iter.first = i;                                          \
+                    break;                                                   \
+                }                                                            \
+            }                                                                \
+            for (size_t i = target->capacity; i > 0; --i) {                  \
+                if (phyto_hash_ctrl_is_full(target->ctrl[i - 1])) {          \
+                    iter.last = i - 1;                                       \
+                    break;                                                   \
+                }                                                            \
+            }                                                                \
+            iter.cursor = iter.last;                                         \
+            iter.index = target->count - 1;                                  \
+        }                                                                    \
+        return iter;                                                         \
+    }                                                                        \
+    bool Name##_iter_at_start(Name##_iter_t* iter) {                         \
+        return Name##_empty(iter->target) || iter->at_start;                 \
+    }                                                                        \
+    bool Name##_iter_at_end(Name##_iter_t* iter) {                           \
+        return Name##_empty(iter->target) || iter->at_end;                   \
+    }                                                                        \
+    bool Name##_iter_to_start(Name##_iter_t* iter) {                         \
+        if (!Name##_empty(iter->target)) {                                   \
+            iter->cursor = iter->first;                                      \
+            iter->index = 0;                                                 \
+            iter->at_start = true;                                           \
+            iter->at_end = false;                                            \
+            return true;                                                     \
+        }                                                                    \
+        return false;                                                        \
+    }                                                                        \
+    bool Name##_iter_to_end(Name##_iter_t* iter) {                           \
+        if (!Name##_empty(iter->target)) {                                   \
+            iter->cursor = iter->last;                                       \
+            iter->index = iter->target->count - 1;                           \
+            iter->at_start = false;                                          \
+            iter->at_end = true;                                             \
+            return true;                                                     \
+        }                                                                    \
+        return false;                                                        \
+    }                                                                        \
+    bool Name##_iter_next(Name##_iter_t* iter) {                             \
+        if (iter->at_end) {                                                  \
+            return false;                                                    \
+        }                                                                    \
+        if (iter->index + 1 == iter->target->count) {                        \
+            iter->at_end = true;                                             \
+            return false;                                                    \
+        }                                                                    \
+        iter->at_start = Name##_empty(iter->target);                         \
+        iter->index++;                                                       \
+        while (true) {                                                       \
+            iter->cursor++;                                                  \
+            if (phyto_hash_ctrl_is_full(iter->target->ctrl[iter->cursor])) { \
+                break;                                                       \
+            }                                                                \
+        }                                                                    \
+        return true;                                                         \
+    }                                                                        \
+    bool Name##_iter_prev(Name##_iter_t* iter) {                             \
+        if (iter->at_start) {                                                \
+            return false;                                                    \
+        }                                                                    \
+        if (iter->index == 0) {                                              \
+            iter->at_start = true;                                           \
+            return false;                                                    \
+        }                                                                    \
+        iter->at_end = Name##_empty(iter->target);                           \
+        iter->index--;                                                       \
+        while (true) {                                                       \
+            iter->cursor--;                                                  \
+            if (phyto_hash_ctrl_is_full(iter->target->ctrl[iter->cursor])) { \
+                break;                                                       \
+            }                                                                \
+        }                                                                    \
+        return true;                                                         \
+    }                                                                        \
+    bool Name##_iter_advance(Name##_iter_t* iter, size_t steps) {            \
+        if (iter->at_end) {                                                  \
+            return false;                                                    \
+        }                                                                    \
+        if (iter->index + 1 == iter->target->count) {                        \
+            iter->at_end = true;                                             \
+            return false;                                                    \
+        }                                                                    \
+        if (steps == 0 || iter->index + steps >= iter->target->count) {      \
+            return false;                                                    \
+        }                                                                    \
+        for (size_t i = 0; i < steps; ++i) {                                 \
+            Name##_iter_next(iter);                                          \
+        }                                                                    \
+        return true;                                                         \
+    }                                                                        \
+    bool Name##_iter_rewind(Name##_iter_t* iter, size_t steps) {             \
+        if (iter->at_start) {                                                \
+            return false;                                                    \
+        }                                                                    \
+        if (iter->index == 0) {                                              \
+            iter->at_start = true;                                           \
+            return false;                                                    \
+        }                                                                    \
+        if (steps == 0 || iter->index < steps) {                             \
+            return false;                                                    \
+        }                                                                    \
+        for (size_t i = 0; i < steps; ++i) {                                 \
+            Name##_iter_prev(iter);                                          \
+        }                                                                    \
+        return true;                                                         \
+    }                                                                        \
+    bool Name##_iter_go_to(Name##_iter_t* iter, size_t index) {              \
+        if (index >= iter->target->count) {                                  \
+            return false;                                                    \
+        }                                                                    \
+        if (iter->index > index) {                                           \
+            return Name##_iter_rewind(iter, iter->index - index);            \
+        }                                                                    \
+        if (iter->index < index) {                                           \
+            return Name##_iter_advance(iter, index - iter->index);           \
+        }                                                                    \
+        return true;                                                         \
+    }                                                                        \
+    phyto_string_span_t Name##_iter_key(Name##_iter_t* iter) {               \
+        if (Name##_empty(iter->target)) {                                    \
+            return phyto_string_span_empty();                                \
+        }                                                                    \
+        return phyto_string_as_span(iter->target->buffer[iter->cursor].key); \
+    }                                                                        \
+    V Name##_iter_value(Name##_iter_t* iter) {                               \
+        if (Name##_empty(iter->target)) {                                    \
+            return (V){0};                                                   \
+        }                                                                    \
+        return iter->target->buffer[iter->cursor].value;                     \
+    }                                                                        \
+    V* Name##_iter_value_ref(Name##_iter_t* iter) {                          \
+        if (Name##_empty(iter->target)) {                                    \
+            return NULL;                                                     \
+        }                                                                    \
+        return &iter->target->buffer[iter->cursor].value;                    \
+    }                                                                        \
     size_t Name##_iter_index(Name##_iter_t* iter) { return iter->index; }
 
 #define PHYTO_HASH_DECL_STR(Name, V)                                                        \
@@ -702,14 +852,14 @@ extern const double phyto_hash_default_load;
         fprintf(fp, "%" PHYTO_STRING_FORMAT, PHYTO_STRING_VIEW_PRINTF_ARGS(start));         \
         size_t last = 0;                                                                    \
         for (size_t i = map->capacity; i > 0; --i) {                                        \
-            if (map->buffer[i - 1].state == Name##_entry_state_filled) {                    \
+            if (phyto_hash_ctrl_is_full(map->ctrl[i - 1])) {                                \
                 last = i - 1;                                                               \
                 break;                                                                      \
             }                                                                               \
         }                                                                                   \
         for (size_t i = 0; i < map->capacity; ++i) {                                        \
             Name##_entry_t* entry = &map->buffer[i];                                        \
-            if (entry->state == Name##_entry_state_filled) {                                \
+            if (phyto_hash_ctrl_is_full(map->ctrl[i])) {                                    \
                 phyto_string_span_print_to(phyto_string_as_span(entry->key), fp);           \
                 fprintf(fp, "%" PHYTO_STRING_FORMAT,                                        \
                         PHYTO_STRING_VIEW_PRINTF_ARGS(key_value_separator));                \
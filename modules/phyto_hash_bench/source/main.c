@@ -0,0 +1,310 @@
+#include <inttypes.h>
+#include <phyto/bench/bench.h>
+#include <phyto/hash/hash.h>
+#include <phyto/string/string.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits/sysexits.h>
+
+PHYTO_HASH_DECL(bench_map, size_t);
+PHYTO_HASH_IMPL(bench_map, size_t)
+
+#define POLICIES_X \
+    X(prime)       \
+    X(pow2)
+
+#define HASHES_X \
+    X(fnv1a)     \
+    X(djb2)
+
+// sequential keys differ only in their last few bytes, which is where weak hashes collide
+#define KEY_SETS_X \
+    X(sequential)  \
+    X(random)
+
+typedef enum {
+#define X(x) key_set_##x,
+    KEY_SETS_X
+#undef X
+    key_set_count,
+} key_set_t;
+
+static const char* const key_set_names[] = {
+#define X(x) #x,
+    KEY_SETS_X
+#undef X
+};
+
+static const char* const policy_names[] = {
+#define X(x) #x,
+    POLICIES_X
+#undef X
+};
+
+static const phyto_hash_policy_t policies[] = {
+#define X(x) phyto_hash_policy_##x,
+    POLICIES_X
+#undef X
+};
+
+static const char* const hash_names[] = {
+#define X(x) #x,
+    HASHES_X
+#undef X
+};
+
+static uint64_t (*const hashes[])(phyto_string_span_t) = {
+#define X(x) phyto_hash_##x,
+    HASHES_X
+#undef X
+};
+
+#define POLICY_COUNT (sizeof(policies) / sizeof(policies[0]))
+#define HASH_COUNT (sizeof(hashes) / sizeof(hashes[0]))
+
+static const bench_map_value_ops_t value_ops = {0};
+
+typedef struct {
+    size_t keys;
+    size_t lookups;
+    size_t iterations;
+    uint64_t seed;
+    bool json;
+} options_t;
+
+typedef struct {
+    size_t policy;
+    size_t hash;
+    key_set_t key_set;
+    size_t capacity;
+    // medians over all iterations
+    double insert_ns;
+    double hit_ns;
+    double miss_ns;
+} result_t;
+
+// misses share a prefix no hit has, so they probe the same table without ever matching
+static phyto_string_t* generate_keys(const options_t* options, key_set_t key_set, bool miss) {
+    phyto_string_t* keys = calloc(options->keys, sizeof(phyto_string_t));
+    if (keys == NULL) {
+        return NULL;
+    }
+    uint64_t rng = options->seed + miss;
+    char buffer[48];
+    for (size_t i = 0; i < options->keys; ++i) {
+        int length;
+        if (key_set == key_set_sequential) {
+            length = snprintf(buffer, sizeof(buffer), "%s%zu", miss ? "miss" : "key", i);
+        } else {
+            length = snprintf(buffer, sizeof(buffer), "%s%016" PRIx64 "%08" PRIx64,
+                              miss ? "miss" : "", phyto_bench_random(&rng),
+                              phyto_bench_random(&rng) >> 32);
+        }
+        keys[i] = phyto_string_own(phyto_string_span_from_array(buffer, (size_t)length));
+    }
+    return keys;
+}
+
+static void free_keys(phyto_string_t* keys, size_t count) {
+    if (keys == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        phyto_string_free(&keys[i]);
+    }
+    free(keys);
+}
+
+static bool bench_one(const options_t* options,
+                      const phyto_string_t* keys,
+                      const phyto_string_t* misses,
+                      const size_t* order,
+                      result_t* result) {
+    const bench_map_key_ops_t key_ops = {
+        .hash = hashes[result->hash],
+        .policy = policies[result->policy],
+    };
+    uint64_t* samples = calloc(options->iterations * 3, sizeof(uint64_t));
+    if (samples == NULL) {
+        return false;
+    }
+    uint64_t* insert = samples;
+    uint64_t* hit = samples + options->iterations;
+    uint64_t* miss = samples + options->iterations * 2;
+    bool ok = true;
+    size_t sink = 0;
+    for (size_t i = 0; i < options->iterations && ok; ++i) {
+        bench_map_t* map = bench_map_new(16, phyto_hash_default_load, &key_ops, &value_ops);
+        if (map == NULL) {
+            ok = false;
+            break;
+        }
+        uint64_t start = phyto_bench_now_ns();
+        for (size_t k = 0; k < options->keys && ok; ++k) {
+            ok = bench_map_insert(map, phyto_string_as_span(keys[k]), k);
+        }
+        uint64_t inserted = phyto_bench_now_ns();
+        for (size_t l = 0; l < options->lookups; ++l) {
+            sink += bench_map_get(map, phyto_string_as_span(keys[order[l]]));
+        }
+        uint64_t hits = phyto_bench_now_ns();
+        for (size_t l = 0; l < options->lookups; ++l) {
+            sink += bench_map_contains(map, phyto_string_as_span(misses[order[l]]));
+        }
+        uint64_t missed = phyto_bench_now_ns();
+        insert[i] = inserted - start;
+        hit[i] = hits - inserted;
+        miss[i] = missed - hits;
+        result->capacity = bench_map_capacity(map);
+        bench_map_free(map);
+    }
+    if (ok) {
+        double keys = (double)options->keys;
+        double lookups = (double)options->lookups;
+        result->insert_ns = (double)phyto_bench_median(insert, options->iterations) / keys;
+        result->hit_ns = (double)phyto_bench_median(hit, options->iterations) / lookups;
+        result->miss_ns = (double)phyto_bench_median(miss, options->iterations) / lookups;
+    }
+    free(samples);
+    // keeps the lookups from being optimized away
+    if (sink == SIZE_MAX) {
+        fprintf(stderr, "\n");
+    }
+    return ok;
+}
+
+static void print_table(const result_t* results, size_t count, FILE* stream) {
+    fprintf(stream, "%-8s %-8s %-12s %10s %12s %12s %12s\n", "policy", "hash", "keys", "capacity",
+            "insert ns", "hit ns", "miss ns");
+    for (size_t i = 0; i < count; ++i) {
+        const result_t* r = &results[i];
+        fprintf(stream, "%-8s %-8s %-12s %10zu %12.1f %12.1f %12.1f\n", policy_names[r->policy],
+                hash_names[r->hash], key_set_names[r->key_set], r->capacity, r->insert_ns,
+                r->hit_ns, r->miss_ns);
+    }
+}
+
+static void print_json(const options_t* options,
+                       const result_t* results,
+                       size_t count,
+                       FILE* stream) {
+    fprintf(stream,
+            "{\"seed\": %" PRIu64 ", \"keys\": %zu, \"lookups\": %zu, \"iterations\": %zu"
+            ", \"results\": [\n",
+            options->seed, options->keys, options->lookups, options->iterations);
+    for (size_t i = 0; i < count; ++i) {
+        const result_t* r = &results[i];
+        fprintf(stream,
+                "  {\"policy\": \"%s\", \"hash\": \"%s\", \"keys\": \"%s\", \"capacity\": %zu"
+                ", \"insert_ns\": %.2f, \"hit_ns\": %.2f, \"miss_ns\": %.2f}%s\n",
+                policy_names[r->policy], hash_names[r->hash], key_set_names[r->key_set],
+                r->capacity, r->insert_ns, r->hit_ns, r->miss_ns, i + 1 == count ? "" : ",");
+    }
+    fprintf(stream, "]}\n");
+}
+
+static int usage(const char* argv0) {
+    printf("Usage: %s [--keys=N] [--lookups=N] [--iterations=N] [--seed=N] [--json] [keys...]\n",
+           argv0);
+    printf("Key sets:");
+    for (size_t i = 0; i < key_set_count; ++i) {
+        printf(" %s", key_set_names[i]);
+    }
+    printf("\n");
+    return EX_USAGE;
+}
+
+int main(int argc, char** argv) {
+    options_t options = {
+        .keys = 1 << 16,
+        .lookups = 1 << 20,
+        .iterations = 5,
+        .seed = 0x4a54ed,
+        .json = false,
+    };
+    int arg = 1;
+    for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; ++arg) {
+        const char* value = strchr(argv[arg], '=');
+        value = value != NULL ? value + 1 : "";
+        uint64_t number = 0;
+        if (strcmp(argv[arg], "--json") == 0) {
+            options.json = true;
+        } else if (!phyto_bench_parse_u64(value, &number) || number == 0) {
+            return usage(argv[0]);
+        } else if (strncmp(argv[arg], "--keys=", 7) == 0) {
+            options.keys = (size_t)number;
+        } else if (strncmp(argv[arg], "--lookups=", 10) == 0) {
+            options.lookups = (size_t)number;
+        } else if (strncmp(argv[arg], "--iterations=", 13) == 0) {
+            options.iterations = (size_t)number;
+        } else if (strncmp(argv[arg], "--seed=", 7) == 0) {
+            options.seed = number;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    bool selected[key_set_count] = {0};
+    size_t selected_count = 0;
+    for (size_t i = 0; i < key_set_count; ++i) {
+        selected[i] = arg == argc;
+        for (int j = arg; j < argc && !selected[i]; ++j) {
+            selected[i] = strcmp(argv[j], key_set_names[i]) == 0;
+        }
+        selected_count += selected[i];
+    }
+    if ((size_t)(argc - arg) > selected_count) {
+        return usage(argv[0]);
+    }
+
+    size_t* order = malloc(options.lookups * sizeof(size_t));
+    result_t* results = calloc(selected_count * POLICY_COUNT * HASH_COUNT, sizeof(result_t));
+    if (order == NULL || results == NULL) {
+        free(order);
+        free(results);
+        fprintf(stderr, "Out of memory\n");
+        return EX_OSERR;
+    }
+    uint64_t rng = options.seed;
+    for (size_t l = 0; l < options.lookups; ++l) {
+        order[l] = phyto_bench_random(&rng) % options.keys;
+    }
+
+    int status = EX_OK;
+    size_t count = 0;
+    for (size_t set = 0; set < key_set_count && status == EX_OK; ++set) {
+        if (!selected[set]) {
+            continue;
+        }
+        phyto_string_t* keys = generate_keys(&options, (key_set_t)set, false);
+        phyto_string_t* misses = generate_keys(&options, (key_set_t)set, true);
+        for (size_t hash = 0; hash < HASH_COUNT && keys && misses && status == EX_OK; ++hash) {
+            for (size_t policy = 0; policy < POLICY_COUNT && status == EX_OK; ++policy) {
+                result_t* result = &results[count++];
+                *result = (result_t){.policy = policy, .hash = hash, .key_set = (key_set_t)set};
+                if (!bench_one(&options, keys, misses, order, result)) {
+                    fprintf(stderr, "Building the %s map failed\n", key_set_names[set]);
+                    status = EX_SOFTWARE;
+                }
+            }
+        }
+        if (keys == NULL || misses == NULL) {
+            fprintf(stderr, "Out of memory\n");
+            status = EX_OSERR;
+        }
+        free_keys(keys, options.keys);
+        free_keys(misses, options.keys);
+    }
+    if (status == EX_OK) {
+        if (options.json) {
+            print_json(&options, results, count, stdout);
+        } else {
+            print_table(results, count, stdout);
+        }
+    }
+    free(order);
+    free(results);
+    return status;
+}
@@ -4,6 +4,7 @@
 #include <phyto/string/string.h>
 #include <phyto/test/test.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "phyto_hash_test/pcre.h"
 
@@ -51,6 +52,11 @@ static const int_map_key_ops_t djb2_key_ops = {
     .hash = phyto_hash_djb2,
 };
 
+static const int_map_key_ops_t pow2_key_ops = {
+    .hash = phyto_hash_djb2,
+    .policy = phyto_hash_policy_pow2,
+};
+
 static const int_map_value_ops_t default_value_ops = {
     .compare = intcmp,
     .copy = intcpy,
@@ -206,6 +212,202 @@ PHYTO_TEST_FUNC(min) {
     PHYTO_TEST_PASS();
 }
 
+#define MANY_KEYS 5000
+
+static phyto_string_span_t numbered_key(char* buffer, size_t size, int i) {
+    int length = snprintf(buffer, size, "key%d", i);
+    return phyto_string_span_from_array(buffer, (size_t)length);
+}
+
+PHYTO_TEST_FUNC(many_keys) {
+    int_map_t* map = int_map_new(10, phyto_hash_default_load, &djb2_key_ops, &default_value_ops);
+    PHYTO_TEST_ASSERT(map != NULL, (void)0, "int_map_new() failed");
+    char buffer[32];
+    for (int i = 0; i < MANY_KEYS; ++i) {
+        PHYTO_TEST_ASSERT(int_map_insert(map, numbered_key(buffer, sizeof(buffer), i), i),
+                          int_map_free(map), "int_map_insert(key%d) failed", i);
+    }
+    for (int i = 0; i < MANY_KEYS; i += 2) {
+        PHYTO_TEST_ASSERT(int_map_remove(map, numbered_key(buffer, sizeof(buffer), i), NULL),
+                          int_map_free(map), "int_map_remove(key%d) failed", i);
+    }
+    for (int i = 0; i < MANY_KEYS; ++i) {
+        bool found = int_map_contains(map, numbered_key(buffer, sizeof(buffer), i));
+        PHYTO_TEST_ASSERT(found == (i % 2 == 1), int_map_free(map),
+                          "int_map_contains(key%d) was %s", i, found ? "true" : "false");
+    }
+    for (int i = 0; i < MANY_KEYS; i += 2) {
+        PHYTO_TEST_ASSERT(int_map_insert(map, numbered_key(buffer, sizeof(buffer), i), -i),
+                          int_map_free(map), "int_map_insert(key%d) failed again", i);
+    }
+    PHYTO_TEST_ASSERT(int_map_count(map) == MANY_KEYS, int_map_free(map),
+                      "int_map_count() == %zu, expected %d", int_map_count(map), MANY_KEYS);
+    for (int i = 0; i < MANY_KEYS; ++i) {
+        int value = int_map_get(map, numbered_key(buffer, sizeof(buffer), i));
+        PHYTO_TEST_ASSERT(value == (i % 2 == 1 ? i : -i), int_map_free(map),
+                          "int_map_get(key%d) == %d", i, value);
+    }
+    int_map_free(map);
+    PHYTO_TEST_PASS();
+}
+
+PHYTO_TEST_FUNC(copy_equals) {
+    int_map_t* map = int_map_new(10, phyto_hash_default_load, &djb2_key_ops, &default_value_ops);
+    int_map_t* other =
+        int_map_new(10, phyto_hash_default_load, &default_key_ops, &default_value_ops);
+    PHYTO_TEST_ASSERT(map != NULL && other != NULL, (int_map_free(map), int_map_free(other)),
+                      "int_map_new() failed");
+    char buffer[32];
+    for (int i = 0; i < MANY_KEYS; ++i) {
+        phyto_string_span_t key = numbered_key(buffer, sizeof(buffer), i);
+        int_map_insert(map, key, i);
+        int_map_insert(other, key, i);
+    }
+    int_map_t* copy = int_map_copy_of(map);
+    PHYTO_TEST_ASSERT(copy != NULL, (int_map_free(map), int_map_free(other)),
+                      "int_map_copy_of() failed");
+    PHYTO_TEST_ASSERT(int_map_equals(map, copy) && int_map_equals(map, other),
+                      (int_map_free(map), int_map_free(other), int_map_free(copy)),
+                      "maps with the same entries compared unequal");
+    int_map_update(copy, numbered_key(buffer, sizeof(buffer), MANY_KEYS / 2), -1, NULL);
+    PHYTO_TEST_ASSERT(!int_map_equals(map, copy),
+                      (int_map_free(map), int_map_free(other), int_map_free(copy)),
+                      "maps with different values compared equal");
+    int_map_free(map);
+    int_map_free(other);
+    int_map_free(copy);
+    PHYTO_TEST_PASS();
+}
+
+PHYTO_TEST_FUNC(pow2_policy) {
+    int_map_t* map = int_map_new(10, phyto_hash_default_load, &pow2_key_ops, &default_value_ops);
+    PHYTO_TEST_ASSERT(map != NULL, (void)0, "int_map_new() failed");
+    char buffer[32];
+    for (int i = 0; i < MANY_KEYS; ++i) {
+        PHYTO_TEST_ASSERT(int_map_insert(map, numbered_key(buffer, sizeof(buffer), i), i),
+                          int_map_free(map), "int_map_insert(key%d) failed", i);
+        size_t capacity = int_map_capacity(map);
+        PHYTO_TEST_ASSERT((capacity & (capacity - 1)) == 0, int_map_free(map),
+                          "int_map_capacity() == %zu, not a power of two", capacity);
+    }
+    for (int i = 0; i < MANY_KEYS; ++i) {
+        int value = int_map_get(map, numbered_key(buffer, sizeof(buffer), i));
+        PHYTO_TEST_ASSERT(value == i, int_map_free(map), "int_map_get(key%d) == %d", i, value);
+    }
+    int_map_free(map);
+    PHYTO_TEST_PASS();
+}
+
+// rejecting a key that is already there must not grow a map sitting at its load limit
+PHYTO_TEST_FUNC(duplicate_at_limit) {
+    int_map_t* map = int_map_new(1, phyto_hash_default_load, &djb2_key_ops, &default_value_ops);
+    PHYTO_TEST_ASSERT(map != NULL, (void)0, "int_map_new() failed");
+    char buffer[32];
+    for (int i = 0; i < 200; ++i) {
+        PHYTO_TEST_ASSERT(int_map_insert(map, numbered_key(buffer, sizeof(buffer), i), i),
+                          int_map_free(map), "int_map_insert(key%d) failed", i);
+        size_t capacity = int_map_capacity(map);
+        PHYTO_TEST_ASSERT(!int_map_insert(map, numbered_key(buffer, sizeof(buffer), 0), 0),
+                          int_map_free(map), "duplicate key0 was inserted");
+        PHYTO_TEST_ASSERT(int_map_capacity(map) == capacity, int_map_free(map),
+                          "duplicate grew the map from %zu to %zu at %d keys", capacity,
+                          int_map_capacity(map), i + 1);
+    }
+    int_map_free(map);
+    PHYTO_TEST_PASS();
+}
+
+#define CHURN_LIVE 1000
+#define CHURN_ROUNDS 100000
+
+PHYTO_TEST_FUNC(churn) {
+    int_map_t* map = int_map_new(10, phyto_hash_default_load, &djb2_key_ops, &default_value_ops);
+    PHYTO_TEST_ASSERT(map != NULL, (void)0, "int_map_new() failed");
+    char buffer[32];
+    for (int i = 0; i < CHURN_LIVE; ++i) {
+        int_map_insert(map, numbered_key(buffer, sizeof(buffer), i), i);
+    }
+    size_t settled_capacity = 0;
+    for (int round = 0; round < CHURN_ROUNDS; ++round) {
+        PHYTO_TEST_ASSERT(int_map_remove(map, numbered_key(buffer, sizeof(buffer), round), NULL),
+                          int_map_free(map), "int_map_remove(key%d) failed", round);
+        int fresh = round + CHURN_LIVE;
+        PHYTO_TEST_ASSERT(int_map_insert(map, numbered_key(buffer, sizeof(buffer), fresh), fresh),
+                          int_map_free(map), "int_map_insert(key%d) failed", fresh);
+        // the insert may take the last slot under the load limit
+        PHYTO_TEST_ASSERT((double)(map->count + map->tombstones) <=
+                              (double)map->capacity * map->load + 1,
+                          int_map_free(map), "%zu tombstones clog a map of %zu at round %d",
+                          map->tombstones, map->count, round);
+        if (round == CHURN_ROUNDS / 2) {
+            settled_capacity = int_map_capacity(map);
+        }
+    }
+    PHYTO_TEST_ASSERT(int_map_capacity(map) == settled_capacity, int_map_free(map),
+                      "int_map_capacity() grew from %zu to %zu under steady churn",
+                      settled_capacity, int_map_capacity(map));
+    for (int i = CHURN_ROUNDS - CHURN_LIVE; i < CHURN_ROUNDS + CHURN_LIVE; ++i) {
+        bool found = int_map_contains(map, numbered_key(buffer, sizeof(buffer), i));
+        PHYTO_TEST_ASSERT(found == (i >= CHURN_ROUNDS), int_map_free(map),
+                          "int_map_contains(key%d) was %s", i, found ? "true" : "false");
+    }
+    int_map_free(map);
+    PHYTO_TEST_PASS();
+}
+
+PHYTO_TEST_FUNC(short_key_fragments) {
+    bool seen[128] = {0};
+    size_t distinct = 0;
+    char buffer[32];
+    for (int i = 0; i < 1000; ++i) {
+        uint64_t hash = phyto_hash_djb2(numbered_key(buffer, sizeof(buffer), i));
+        uint8_t fragment = phyto_hash_fragment(hash);
+        PHYTO_TEST_ASSERT(fragment < 128, (void)0, "key%d has fragment 0x%02x", i, fragment);
+        distinct += !seen[fragment];
+        seen[fragment] = true;
+    }
+    // with uniform fragments, 1000 keys leave on average well under one of the 128 unused
+    PHYTO_TEST_ASSERT(distinct >= 120, (void)0, "short djb2 keys share %zu of 128 fragments",
+                      distinct);
+    PHYTO_TEST_PASS();
+}
+
+#ifdef PHYTO_ALLOC_STATS
+static const phyto_alloc_stats_t* find_alloc_stats(const char* name) {
+    for (const phyto_alloc_stats_t* s = phyto_alloc_stats_first(); s != NULL; s = s->next) {
+        if (strcmp(s->name, name) == 0) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+PHYTO_TEST_FUNC(alloc_stats) {
+    int_map_t* map = int_map_new(1, phyto_hash_default_load, &djb2_key_ops, &default_value_ops);
+    PHYTO_TEST_ASSERT(map != NULL, (void)0, "int_map_new() failed");
+    const phyto_alloc_stats_t* stats = find_alloc_stats("int_map");
+    PHYTO_TEST_ASSERT(stats != NULL, int_map_free(map), "no int_map record");
+    uint64_t bytes = stats->bytes_allocated;
+    uint64_t peak = stats->peak_bytes;
+    uint64_t reallocations = stats->reallocations;
+    // more keys than any other map in this file holds, so the peak has to move
+    char buffer[32];
+    for (int i = 0; i < MANY_KEYS * 4; ++i) {
+        PHYTO_TEST_ASSERT(int_map_insert(map, numbered_key(buffer, sizeof(buffer), i), i),
+                          int_map_free(map), "int_map_insert(key%d) failed", i);
+    }
+    PHYTO_TEST_ASSERT(stats->bytes_allocated > bytes, int_map_free(map),
+                      "bytes_allocated did not grow");
+    PHYTO_TEST_ASSERT(stats->peak_bytes > peak && stats->peak_bytes >= stats->live_bytes,
+                      int_map_free(map), "peak_bytes == %" PRIu64 ", was %" PRIu64,
+                      stats->peak_bytes, peak);
+    PHYTO_TEST_ASSERT(stats->reallocations > reallocations, int_map_free(map),
+                      "growing was not counted as a reallocation");
+    int_map_free(map);
+    PHYTO_TEST_PASS();
+}
+#endif
+
 PHYTO_TEST_SUITE_FUNC(basics) {
     PHYTO_TEST_RUN(allocation);
     PHYTO_TEST_RUN(insert_once);
@@ -216,6 +418,15 @@ PHYTO_TEST_SUITE_FUNC(basics) {
     PHYTO_TEST_RUN(insert_remove);
     PHYTO_TEST_RUN(max);
     PHYTO_TEST_RUN(min);
+    PHYTO_TEST_RUN(many_keys);
+    PHYTO_TEST_RUN(short_key_fragments);
+    PHYTO_TEST_RUN(copy_equals);
+    PHYTO_TEST_RUN(pow2_policy);
+    PHYTO_TEST_RUN(duplicate_at_limit);
+    PHYTO_TEST_RUN(churn);
+#ifdef PHYTO_ALLOC_STATS
+    PHYTO_TEST_RUN(alloc_stats);
+#endif
 }
 
 PHYTO_TEST_FUNC(empty) {
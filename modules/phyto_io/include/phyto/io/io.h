@@ -2,10 +2,23 @@
 #define PHYTO_IO_IO_H_
 
 #include <phyto/string/string.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 
+// a read-only view of a whole file. where the file cannot be mapped (pipes, some special
+// files, platforms without mmap) it is read into `fallback` and `data` points there instead
+typedef struct {
+    const char* data;
+    size_t size;
+    phyto_string_t fallback;
+} phyto_io_mapping_t;
+
 phyto_string_t phyto_io_read_file(const char* path);
 phyto_string_t phyto_io_read_line(FILE* stream);
+bool phyto_io_map_file(const char* path, phyto_io_mapping_t* out_mapping);
+phyto_string_span_t phyto_io_mapping_as_span(phyto_io_mapping_t mapping);
+void phyto_io_unmap_file(phyto_io_mapping_t* mapping);
 
 #endif  // PHYTO_IO_IO_H_
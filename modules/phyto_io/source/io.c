@@ -3,6 +3,13 @@
 #include <phyto/string/string.h>
 #include <stdio.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 phyto_string_t phyto_io_read_file(const char* path) {
     phyto_string_t result = phyto_string_new();
     FILE* file = fopen(path, "r");
@@ -27,3 +34,51 @@ phyto_string_t phyto_io_read_line(FILE* stream) {
     }
     return result;
 }
+
+static bool map_file_fallback(const char* path, phyto_io_mapping_t* out_mapping) {
+    out_mapping->fallback = phyto_io_read_file(path);
+    out_mapping->data = out_mapping->fallback.data;
+    out_mapping->size = out_mapping->fallback.size;
+    return out_mapping->size > 0;
+}
+
+bool phyto_io_map_file(const char* path, phyto_io_mapping_t* out_mapping) {
+    *out_mapping = (phyto_io_mapping_t){0};
+#ifdef _WIN32
+    return map_file_fallback(path, out_mapping);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return map_file_fallback(path, out_mapping);
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+    if (data == MAP_FAILED) {
+        return map_file_fallback(path, out_mapping);
+    }
+    out_mapping->data = data;
+    out_mapping->size = (size_t)st.st_size;
+    return true;
+#endif
+}
+
+phyto_string_span_t phyto_io_mapping_as_span(phyto_io_mapping_t mapping) {
+    return phyto_string_span_from_array(mapping.data, mapping.size);
+}
+
+void phyto_io_unmap_file(phyto_io_mapping_t* mapping) {
+    if (mapping->fallback.data != NULL) {
+        phyto_string_free(&mapping->fallback);
+#ifndef _WIN32
+    } else if (mapping->data != NULL) {
+        munmap((void*)mapping->data, mapping->size);
+#endif
+    }
+    *mapping = (phyto_io_mapping_t){0};
+}
@@ -29,10 +29,10 @@ typedef struct {
     }
 
 #define PHYTO_VEC_INIT(V) memset((V), 0, sizeof(*(V)))
-#define PHYTO_VEC_FREE(V)  \
-    do {                   \
-        free((V)->data);   \
-        PHYTO_VEC_INIT(V); \
+#define PHYTO_VEC_FREE(V)                     \
+    do {                                      \
+        phyto_vec_free_(PHYTO_VEC_UNPACK(V)); \
+        PHYTO_VEC_INIT(V);                    \
     } while (0)
 
 #define PHYTO_VEC_PUSH(V, Val)                             \
@@ -134,6 +134,7 @@ bool phyto_vec_expand_(phyto_vec_unpacked_t vec);
 bool phyto_vec_reserve_(phyto_vec_unpacked_t vec, size_t n);
 bool phyto_vec_reserve_po2_(phyto_vec_unpacked_t vec, size_t n);
 bool phyto_vec_compact_(phyto_vec_unpacked_t vec);
+void phyto_vec_free_(phyto_vec_unpacked_t vec);
 bool phyto_vec_insert_(phyto_vec_unpacked_t vec, size_t idx);
 void phyto_vec_splice_(phyto_vec_unpacked_t vec, size_t start, size_t count);
 void phyto_vec_swapsplice_(phyto_vec_unpacked_t vec, size_t start, size_t count);
@@ -1,7 +1,11 @@
 #include "phyto/vec/vec.h"
 
+#include <phyto/collections/alloc_stats.h>
 #include <stdlib.h>
 
+// vecs are untyped here, so every element type shares one record
+PHYTO_ALLOC_STATS_DEFINE(phyto_vec_alloc_stats, "phyto_vec")
+
 bool phyto_vec_expand_(phyto_vec_unpacked_t vec) {
     if (*vec.p_size + 1 > *vec.p_capacity) {
         size_t n = (*vec.p_capacity == 0) ? 1 : *vec.p_capacity << 1;
@@ -9,6 +13,8 @@ bool phyto_vec_expand_(phyto_vec_unpacked_t vec) {
         if (ptr == NULL) {
             return false;
         }
+        PHYTO_ALLOC_STATS_RECORD(phyto_vec_alloc_stats, *vec.p_capacity * vec.element_size,
+                                 n * vec.element_size);
         *vec.p_data = ptr;
         *vec.p_capacity = n;
     }
@@ -20,6 +26,8 @@ bool phyto_vec_reserve_(phyto_vec_unpacked_t vec, size_t n) {
         if (ptr == NULL) {
             return false;
         }
+        PHYTO_ALLOC_STATS_RECORD(phyto_vec_alloc_stats, *vec.p_capacity * vec.element_size,
+                                 n * vec.element_size);
         *vec.p_data = ptr;
         *vec.p_capacity = n;
     }
@@ -37,6 +45,7 @@ bool phyto_vec_reserve_po2_(phyto_vec_unpacked_t vec, size_t n) {
 }
 bool phyto_vec_compact_(phyto_vec_unpacked_t vec) {
     if (*vec.p_size == 0) {
+        PHYTO_ALLOC_STATS_RECORD(phyto_vec_alloc_stats, *vec.p_capacity * vec.element_size, 0);
         free(*vec.p_data);
         *vec.p_data = NULL;
         *vec.p_capacity = 0;
@@ -46,10 +55,18 @@ bool phyto_vec_compact_(phyto_vec_unpacked_t vec) {
     if (ptr == NULL) {
         return false;
     }
+    PHYTO_ALLOC_STATS_RECORD(phyto_vec_alloc_stats, *vec.p_capacity * vec.element_size,
+                             *vec.p_size * vec.element_size);
     *vec.p_capacity = *vec.p_size;
     *vec.p_data = ptr;
     return true;
 }
+void phyto_vec_free_(phyto_vec_unpacked_t vec) {
+    PHYTO_ALLOC_STATS_WASTE(phyto_vec_alloc_stats,
+                            (*vec.p_capacity - *vec.p_size) * vec.element_size);
+    PHYTO_ALLOC_STATS_RECORD(phyto_vec_alloc_stats, *vec.p_capacity * vec.element_size, 0);
+    free(*vec.p_data);
+}
 bool phyto_vec_insert_(phyto_vec_unpacked_t vec, size_t idx) {
     if (!phyto_vec_expand_(vec)) {
         return false;
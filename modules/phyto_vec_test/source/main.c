@@ -1,4 +1,5 @@
 #include <inttypes.h>
+#include <phyto/collections/alloc_stats.h>
 #include <phyto/test/test.h>
 #include <phyto/vec/vec.h>
 
@@ -265,6 +266,39 @@ PHYTO_TEST_FUNC(vec_find) {
     PHYTO_TEST_PASS();
 }
 
+#ifdef PHYTO_ALLOC_STATS
+static const phyto_alloc_stats_t* find_alloc_stats(const char* name) {
+    for (const phyto_alloc_stats_t* s = phyto_alloc_stats_first(); s != NULL; s = s->next) {
+        if (strcmp(s->name, name) == 0) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+PHYTO_TEST_FUNC(vec_alloc_stats) {
+    vec_int_t v;
+    PHYTO_VEC_INIT(&v);
+    for (int i = 0; i < 5; ++i) {
+        PHYTO_VEC_PUSH(&v, i);
+    }
+    const phyto_alloc_stats_t* stats = find_alloc_stats("phyto_vec");
+    PHYTO_TEST_ASSERT(stats != NULL, PHYTO_VEC_FREE(&v), "no phyto_vec record");
+    uint64_t live = stats->live_bytes;
+    uint64_t wasted = stats->wasted_bytes;
+    PHYTO_TEST_ASSERT(live >= 8 * sizeof(int), PHYTO_VEC_FREE(&v),
+                      "live_bytes == %" PRIu64 ", expected at least %zu", live, 8 * sizeof(int));
+    PHYTO_VEC_FREE(&v);
+    PHYTO_TEST_ASSERT(stats->live_bytes == live - 8 * sizeof(int), (void)0,
+                      "live_bytes == %" PRIu64 " after free, expected %" PRIu64,
+                      stats->live_bytes, live - 8 * sizeof(int));
+    PHYTO_TEST_ASSERT(stats->wasted_bytes == wasted + 3 * sizeof(int), (void)0,
+                      "wasted_bytes == %" PRIu64 ", expected %" PRIu64, stats->wasted_bytes,
+                      wasted + 3 * sizeof(int));
+    PHYTO_TEST_PASS();
+}
+#endif
+
 PHYTO_TEST_SUITE_FUNC(vec_tests) {
     PHYTO_TEST_RUN(vec_push);
     PHYTO_TEST_RUN(vec_pop);
@@ -279,6 +313,9 @@ PHYTO_TEST_SUITE_FUNC(vec_tests) {
     PHYTO_TEST_RUN(vec_push_array);
     PHYTO_TEST_RUN(vec_push_vec);
     PHYTO_TEST_RUN(vec_find);
+#ifdef PHYTO_ALLOC_STATS
+    PHYTO_TEST_RUN(vec_alloc_stats);
+#endif
 }
 
 int main(void) {